@@ -30,7 +30,7 @@ int main()
     //Load widgets from a file
     auto& wm = console.getWidgetManager(scr);
     auto widgetIds = wm.loadWidgetsFromFile("res/screens/loadfromfilescr.json");
-    auto list = wm.getWidget<conslr::widgets::CheckList<int32_t>>(widgetIds.at("CheckList1"));
+    auto list = wm.getHandle<conslr::widgets::CheckList<int32_t>>(widgetIds.at("CheckList1"));
 
     SDL_Event event;
     bool running = true;
@@ -47,19 +47,19 @@ int main()
             {
                 if (event.key.keysym.scancode == SDL_SCANCODE_DOWN)
                 {
-                    list.lock()->scrollDown();
+                    wm.get(list).scrollDown();
                 }
 
                 if (event.key.keysym.scancode == SDL_SCANCODE_UP)
                 {
-                    list.lock()->scrollUp();
+                    wm.get(list).scrollUp();
                 }
 
                 if (event.key.keysym.scancode == SDL_SCANCODE_RETURN)
                 {
-                    if (list.lock()->size() != 0)
+                    if (wm.get(list).size() != 0)
                     {
-                        list.lock()->toggleCurrentElement();
+                        wm.get(list).toggleCurrentElement();
                     }
                 }
             }
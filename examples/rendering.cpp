@@ -27,7 +27,7 @@ public:
             mX += mVelocityX;
             mY += mVelocityY;
 
-            mRerender = true;
+            invalidate();
         }
 
         return;
@@ -39,8 +39,6 @@ public:
 
         scr.setCellBackground(mRegion.x + mX, mRegion.y + mY, { 255, 0, 255, 255 });
 
-        mRerender = false;
-
         return;
     }
 
@@ -0,0 +1,332 @@
+///Text rendering benchmark
+///
+///Times the Screen text functions against a copy of the per character loops they replaced
+///and checks that both write the same cells, the results are printed to the console
+///Build with optimizations for meaningful numbers
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <SDL.h>
+
+#include <conslr/console.hpp>
+#include <conslr/screen.hpp>
+#include <conslr/taggedstring.hpp>
+#include <conslr/widget.hpp>
+
+using namespace conslr;
+
+using Cell = std::remove_cvref_t<decltype(std::declval<const Screen&>().getCells())>::value_type;
+
+///The text loops of Screen before they shared one layout core, writing to their own cells
+struct OldScreen
+{
+    int32_t mWidth;
+    int32_t mHeight;
+    std::vector<Cell> mCells;
+
+    void renderTextColor(int32_t x, int32_t y, int32_t maxSize, const std::string& str, const SDL_Color& color)
+    {
+        if (y < 0 || y >= mHeight) { return; }
+
+        int32_t itrSize = std::min(maxSize, (int32_t)str.size());
+        int32_t start = (y * mWidth) + x;
+        for (int i = 0; i < itrSize; i++)
+        {
+            if (x + i < 0 || x + i >= mWidth) { continue; }
+
+            auto& cell = mCells.at(start + i);
+
+            cell.character = (unsigned char)str.at(i);
+            cell.foreground = color;
+        }
+
+        return;
+    }
+
+    void renderMultilineText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str)
+    {
+        int32_t i = 0;
+        int32_t j = 0;
+        for (const auto& c : str)
+        {
+            if (c == '\n')
+            {
+                i = 0;
+                j++;
+                continue;
+            }
+
+            if (i >= maxWidth)
+            {
+                i = 0;
+                j++;
+            }
+
+            if (j >= maxHeight)
+            {
+                break;
+            }
+
+            if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+
+            mCells.at(((j + y) * mWidth) + x + i).character = (unsigned char)c;
+            i++;
+        }
+
+        return;
+    }
+
+    void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& color)
+    {
+        int32_t i = 0;
+        int32_t j = 0;
+        for (const auto& c : str)
+        {
+            if (c == '\n')
+            {
+                i = 0;
+                j++;
+                continue;
+            }
+
+            if (i >= maxWidth)
+            {
+                i = 0;
+                j++;
+            }
+
+            if (j >= maxHeight)
+            {
+                break;
+            }
+
+            if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+
+            auto& cell = mCells.at(((j + y) * mWidth) + x + i);
+
+            cell.character = (unsigned char)c;
+            cell.foreground = color;
+
+            i++;
+        }
+
+        return;
+    }
+
+    void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& foreground, const SDL_Color& background)
+    {
+        int32_t i = 0;
+        int32_t j = 0;
+        for (const auto& c : str)
+        {
+            if (c == '\n')
+            {
+                i = 0;
+                j++;
+                continue;
+            }
+
+            if (i >= maxWidth)
+            {
+                i = 0;
+                j++;
+            }
+
+            if (j >= maxHeight)
+            {
+                break;
+            }
+
+            if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+
+            auto& cell = mCells.at(((j + y) * mWidth) + x + i);
+
+            cell.character = (unsigned char)c;
+            cell.foreground = foreground;
+            cell.background = background;
+            i++;
+        }
+
+        return;
+    }
+
+    void renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const TaggedString& str, const TagSet& tags)
+    {
+        int32_t i = 0;
+        int32_t j = 0;
+        for (const auto& tc : str.str)
+        {
+            if (tc.character == '\n')
+            {
+                i = 0;
+                j++;
+                continue;
+            }
+
+            if (i >= maxWidth)
+            {
+                i = 0;
+                j++;
+            }
+
+            if (j >= maxHeight)
+            {
+                break;
+            }
+
+            if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+
+            auto& cell = mCells.at(((j + y) * mWidth) + x + i);
+            uint8_t bg = (tc.tags & TaggedChar::BACKGROUND_MASK) >> 4;
+            uint8_t fg = tc.tags & TaggedChar::FOREGROUND_MASK;
+
+            cell.character = tc.character;
+
+            cell.foreground = tags.at(fg);
+            cell.background = tags.at(bg);
+
+            i++;
+        }
+
+        return;
+    }
+};
+
+///Runs the benchmark on the screen it is rendered to, once
+class BenchmarkWidget : public IWidget, public IRenderable
+{
+public:
+    constexpr BenchmarkWidget(int32_t id, int32_t priority) noexcept :
+        IWidget{ id, priority }, IRenderable{}
+    {}
+
+    virtual void render(Screen& scr)
+    {
+        if (mDone)
+        {
+            return;
+        }
+        mDone = true;
+
+        OldScreen old{ scr.getWidth(), scr.getHeight(), scr.getCells() };
+
+        //About 8KB of lines of random letters, with a newline every 20 characters on average
+        std::mt19937 rng{ 42 };
+        std::string text;
+        while (text.size() < 8192)
+        {
+            for (int32_t i = 0; i < 80; i++)
+            {
+                text += rng() % 20 == 0 ? '\n' : (char)('a' + rng() % 26);
+            }
+            text += '\n';
+        }
+        TaggedString taggedText{ text, 1, 2 };
+
+        TagSet tags;
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            tags[i] = { (uint8_t)(i * 10), (uint8_t)(i * 5), i, 255 };
+        }
+        SDL_Color fg{ 1, 2, 3, 4 };
+        SDL_Color bg{ 5, 6, 7, 8 };
+        std::string line(150, 'x');
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Screen " << scr.getWidth() << "x" << scr.getHeight() << ", 150x50 pane, " << text.size() << " bytes of text, us per call" << std::endl;
+
+        compare(scr, old, "multiline, no color",
+            [&]() { old.renderMultilineText(5, 5, 150, 50, text); },
+            [&]() { scr.renderMultilineText(5, 5, 150, 50, text); });
+        compare(scr, old, "multiline, fg+bg",
+            [&]() { old.renderMultilineTextColor(5, 5, 150, 50, text, fg, bg); },
+            [&]() { scr.renderMultilineTextColor(5, 5, 150, 50, text, fg, bg); });
+        compare(scr, old, "multiline, tagged",
+            [&]() { old.renderMultilineTextTagged(5, 5, 150, 50, taggedText, tags); },
+            [&]() { scr.renderMultilineTextTagged(5, 5, 150, 50, taggedText, tags); });
+        compare(scr, old, "multiline, scrolled y=-200",
+            [&]() { old.renderMultilineTextColor(5, -200, 150, 260, text, fg); },
+            [&]() { scr.renderMultilineTextColor(5, -200, 150, 260, text, fg); });
+        compare(scr, old, "60 single lines, fg",
+            [&]() { for (int32_t y = 0; y < 60; y++) { old.renderTextColor(5, y, 150, line, fg); } },
+            [&]() { for (int32_t y = 0; y < 60; y++) { scr.renderTextColor(5, y, 150, line, fg); } });
+
+        return;
+    }
+
+private:
+    static constexpr int32_t ITERATIONS = 2000;
+
+    ///Times both functions and checks they write the same cells
+    template <typename OldFn, typename NewFn>
+    static void compare(Screen& scr, OldScreen& old, const char* name, OldFn oldFn, NewFn newFn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < ITERATIONS; i++)
+        {
+            oldFn();
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < ITERATIONS; i++)
+        {
+            newFn();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double oldTime = std::chrono::duration<double, std::micro>(middle - start).count() / ITERATIONS;
+        double newTime = std::chrono::duration<double, std::micro>(end - middle).count() / ITERATIONS;
+
+        const auto& cells = scr.getCells();
+        bool same = true;
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            const auto& a = cells[i];
+            const auto& b = old.mCells[i];
+            if (a.character != b.character || std::memcmp(&a.foreground, &b.foreground, sizeof(SDL_Color)) != 0 || std::memcmp(&a.background, &b.background, sizeof(SDL_Color)) != 0)
+            {
+                same = false;
+                break;
+            }
+        }
+        //Both start the next case from the same cells
+        old.mCells = cells;
+
+        std::cout << std::left << std::setw(28) << name << std::right
+            << " old " << std::setw(8) << oldTime
+            << " new " << std::setw(8) << newTime
+            << (same ? "" : "  cells differ") << std::endl;
+
+        return;
+    }
+
+    bool mDone = false;
+};
+
+int main()
+{
+    Console console{ 8, 16, 160, 60 };
+    console.setTitle("Text Benchmark");
+
+    int32_t font = console.createFont("res/ibm_vga_fontsheet.bmp", 8, 16);
+    console.setCurrentFontIndex(font);
+
+    int32_t scr = console.createScreen();
+    console.setCurrentScreenIndex(scr);
+
+    auto& wm = console.getWidgetManager(scr);
+    auto benchmark = wm.createWidget<BenchmarkWidget>();
+    (void)benchmark;
+
+    console.render();
+
+    SDL_Quit();
+
+    return 0;
+}
@@ -6,7 +6,7 @@
 ///Enter to select menu options
 ///Enter to confirm file name
 #include <ios>
-#include <iterator>
+#include <sstream>
 #include <memory>
 #include <string>
 #include <fstream>
@@ -52,41 +52,44 @@ int main()
 
     //Create main screen
     auto& mainWm = console.getWidgetManager(mainScr);
-    auto text = mainWm.createWidget<widgets::TextInput>(10);
+    auto text = mainWm.createWidgetHandle<widgets::TextInput>(10);
     {
-        auto ptr = text.lock();
-        ptr->setTitle("Untitled.txt");
-        ptr->showTitle();
-        ptr->setRegion({ 0, 0, 60, 24 });
+        auto& widget = mainWm.get(text);
+        widget.setTitle("Untitled.txt");
+        widget.showTitle();
+        widget.setRegion({ 0, 0, 60, 24 });
     }
 
-    auto menu = mainWm.createWidget<widgets::ScrollList<MenuOptions>>(10);
+    auto menu = mainWm.createWidgetHandle<widgets::ScrollList<MenuOptions>>(10);
     {
-        auto ptr = menu.lock();
-        ptr->setTitle("Options");
-        ptr->showTitle();
-        ptr->setRegion({ 60, 0, 20, 24 });
-        ptr->setActive(true);
+        auto& widget = mainWm.get(menu);
+        widget.setTitle("Options");
+        widget.showTitle();
+        widget.setRegion({ 60, 0, 20, 24 });
+        mainWm.activateWidget(widget.getId());
         
-        ptr->addElement(MenuOptions::New, "New");
-        ptr->addElement(MenuOptions::Open, "Open");
-        ptr->addElement(MenuOptions::Save, "Save");
-        ptr->addElement(MenuOptions::SaveAs, "Save As");
-        ptr->addElement(MenuOptions::Exit, "Exit");
+        widget.addElement(MenuOptions::New, "New");
+        widget.addElement(MenuOptions::Open, "Open");
+        widget.addElement(MenuOptions::Save, "Save");
+        widget.addElement(MenuOptions::SaveAs, "Save As");
+        widget.addElement(MenuOptions::Exit, "Exit");
     }
 
-    auto optionsInput = mainWm.createWidget<widgets::TextInput>(12);
+    auto optionsInput = mainWm.createWidgetHandle<widgets::TextInput>(12);
     {
-        auto ptr = optionsInput.lock();
-        ptr->setTitle("Enter File Name");
-        ptr->showTitle();
-        ptr->hide();
-        ptr->setMaxRows(1);
-        ptr->setRegion({ 10, 8, 40, 3 });
+        auto& widget = mainWm.get(optionsInput);
+        widget.setTitle("Enter File Name");
+        widget.showTitle();
+        widget.hide();
+        widget.setMaxRows(1);
+        widget.setRegion({ 10, 8, 40, 3 });
     }
 
     std::string fileName = "Untitled.txt";
 
+    //Arrow keys, backspace, return and text input go to the active widget
+    console.setEventRouting(true);
+
     SDL_StopTextInput();
     AppState state = AppState::Options;
     MenuOptions chosenOption = MenuOptions::New;
@@ -101,20 +104,6 @@ int main()
                 running = false;
             }
 
-            if (event.type == SDL_TEXTINPUT)
-            {                
-                assert(state == AppState::Editing || state == AppState::EnterFile);
-
-                if (state == AppState::Editing)
-                {
-                    text.lock()->doTextInput(event.text);
-                }
-                else if (state == AppState::EnterFile)
-                {
-                    optionsInput.lock()->doTextInput(event.text);
-                }
-            }
-
             if (event.type == SDL_KEYDOWN)
             {
                 SDL_Scancode sc = event.key.keysym.scancode;
@@ -125,26 +114,29 @@ int main()
                     {
                         //Begin editing
                         state = AppState::Editing;
-                        mainWm.deactivateWidget(menu.lock()->getId());
-                        mainWm.activateWidget(text.lock()->getId());
+                        mainWm.deactivateWidget(menu.getId());
+                        mainWm.activateWidget(text.getId());
                         SDL_StartTextInput();
                     }
-                    else if (sc == SDL_SCANCODE_UP) { menu.lock()->scrollUp(); }
-                    else if (sc == SDL_SCANCODE_DOWN) { menu.lock()->scrollDown(); }
+                    else if (sc == SDL_SCANCODE_TAB)
+                    {
+                        //The state decides which widget is active, so tab is not routed to move focus away from the menu
+                        continue;
+                    }
                     else if (sc == SDL_SCANCODE_RETURN)
                     {
                         //Choose option
-                        auto option = menu.lock()->getCurrentElement().mElement;
+                        auto option = mainWm.get(menu).getCurrentElement().mElement;
 
                         if (option == MenuOptions::New)
                         {
                             state = AppState::EnterFile;
                             chosenOption = option;
 
-                            mainWm.deactivateWidget(menu.lock()->getId());
-                            mainWm.activateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->show();
-                            optionsInput.lock()->setString("");
+                            mainWm.deactivateWidget(menu.getId());
+                            mainWm.activateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).show();
+                            mainWm.get(optionsInput).setString("");
 
                             SDL_StartTextInput();
                         }
@@ -153,10 +145,10 @@ int main()
                             state = AppState::EnterFile;
                             chosenOption = option;
 
-                            mainWm.deactivateWidget(menu.lock()->getId());
-                            mainWm.activateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->show();
-                            optionsInput.lock()->setString("");
+                            mainWm.deactivateWidget(menu.getId());
+                            mainWm.activateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).show();
+                            mainWm.get(optionsInput).setString("");
 
                             SDL_StartTextInput();
 
@@ -166,7 +158,7 @@ int main()
                             std::ofstream ofs(fileName, std::ios_base::trunc);
                             if (ofs.good())
                             {
-                                ofs << text.lock()->getString();
+                                mainWm.get(text).writeString(ofs);
                                 ofs.close();
                             }
                        }
@@ -175,10 +167,10 @@ int main()
                             state = AppState::EnterFile;
                             chosenOption = option;
 
-                            mainWm.deactivateWidget(menu.lock()->getId());
-                            mainWm.activateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->show();
-                            optionsInput.lock()->setString("");
+                            mainWm.deactivateWidget(menu.getId());
+                            mainWm.activateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).show();
+                            mainWm.get(optionsInput).setString("");
 
                             SDL_StartTextInput();
                         }
@@ -194,17 +186,10 @@ int main()
                     {
                         //End editing
                         state = AppState::Options;
-                        mainWm.activateWidget(menu.lock()->getId());
-                        mainWm.deactivateWidget(text.lock()->getId());
+                        mainWm.activateWidget(menu.getId());
+                        mainWm.deactivateWidget(text.getId());
                         SDL_StopTextInput();
                     }
-                    else if (sc == SDL_SCANCODE_UP) { text.lock()->doKeyUp(); }
-                    else if (sc == SDL_SCANCODE_DOWN) { text.lock()->doKeyDown(); }
-                    else if (sc == SDL_SCANCODE_LEFT) { text.lock()->doKeyLeft(); }
-                    else if (sc == SDL_SCANCODE_RIGHT) { text.lock()->doKeyRight(); }
-                    else if (sc == SDL_SCANCODE_TAB) { text.lock()->doTab(); }
-                    else if (sc == SDL_SCANCODE_RETURN) { text.lock()->doReturn(); }
-                    else if (sc == SDL_SCANCODE_BACKSPACE) { text.lock()->doBackspace(); } 
                 }
                 else if (state == AppState::EnterFile)
                 {
@@ -213,9 +198,9 @@ int main()
                         //Exit without doing option
                         state = AppState::Options;
 
-                        mainWm.activateWidget(menu.lock()->getId());
-                        mainWm.deactivateWidget(optionsInput.lock()->getId());
-                        optionsInput.lock()->hide();
+                        mainWm.activateWidget(menu.getId());
+                        mainWm.deactivateWidget(optionsInput.getId());
+                        mainWm.get(optionsInput).hide();
 
                         SDL_StopTextInput();
                     }
@@ -224,71 +209,65 @@ int main()
                         //Exit and do option
                         if (chosenOption == MenuOptions::New)
                         {
-                            fileName = optionsInput.lock()->getString();
+                            fileName = mainWm.get(optionsInput).getString();
                             state = AppState::Options;
 
-                            mainWm.activateWidget(menu.lock()->getId());
-                            mainWm.deactivateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->hide();
-                            text.lock()->setTitle(fileName);
-                            text.lock()->setString("");
+                            mainWm.activateWidget(menu.getId());
+                            mainWm.deactivateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).hide();
+                            mainWm.get(text).setTitle(fileName);
+                            mainWm.get(text).setString("");
 
                             SDL_StopTextInput();
                         }
                         else if (chosenOption == MenuOptions::Open)
                         {
-                            fileName = optionsInput.lock()->getString();
+                            fileName = mainWm.get(optionsInput).getString();
                             state = AppState::Options;
 
-                            mainWm.activateWidget(menu.lock()->getId());
-                            mainWm.deactivateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->hide();
-                            text.lock()->setTitle(fileName);
+                            mainWm.activateWidget(menu.getId());
+                            mainWm.deactivateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).hide();
+                            mainWm.get(text).setTitle(fileName);
                             
                             SDL_StopTextInput();
 
                             std::ifstream ifs(fileName);
                             if (ifs.good())
                             {
-                                std::string str
-                                {
-                                    std::istreambuf_iterator<char>(ifs),
-                                    std::istreambuf_iterator<char>()
-                                };
+                                std::stringstream ss;
+                                ss << ifs.rdbuf();
 
-                                text.lock()->setString(str);
+                                mainWm.get(text).setString(std::move(ss).str());
                                 ifs.close();
                             }
                             else
                             {
-                                text.lock()->setString("Failed to open file: " + fileName);
+                                mainWm.get(text).setString("Failed to open file: " + fileName);
                                 ifs.close();
                             }
                            
                         }
                         else if (chosenOption == MenuOptions::SaveAs)
                         {
-                            fileName = optionsInput.lock()->getString();
+                            fileName = mainWm.get(optionsInput).getString();
                             state = AppState::Options;
 
-                            mainWm.activateWidget(menu.lock()->getId());
-                            mainWm.deactivateWidget(optionsInput.lock()->getId());
-                            optionsInput.lock()->hide();
-                            text.lock()->setTitle(fileName);
+                            mainWm.activateWidget(menu.getId());
+                            mainWm.deactivateWidget(optionsInput.getId());
+                            mainWm.get(optionsInput).hide();
+                            mainWm.get(text).setTitle(fileName);
                             
                             SDL_StopTextInput();
 
                             std::ofstream ofs(fileName, std::ios_base::trunc);
                             if (ofs.good())
                             {
-                                ofs << text.lock()->getString();
+                                mainWm.get(text).writeString(ofs);
                                 ofs.close();
                             }
                         }
                     }
-                    else if (sc == SDL_SCANCODE_LEFT) { optionsInput.lock()->doKeyLeft(); }
-                    else if (sc == SDL_SCANCODE_RIGHT) { optionsInput.lock()->doKeyRight(); }
-                    else if (sc == SDL_SCANCODE_BACKSPACE) { optionsInput.lock()->doBackspace(); }
                 }
             }
 
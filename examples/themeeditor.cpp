@@ -255,7 +255,7 @@ int main()
         
         for (auto i = 0; i < 40; i++)
         {
-            ptr->addElement({ i, false }, std::to_string(i));
+            ptr->addElement(i, std::to_string(i), false);
         }
     }
 
@@ -39,7 +39,7 @@ int main()
         listPtr->setTitle("List");
         for (auto i = 0; i < 30; i++)
         {
-            listPtr->addElement({ i, false }, std::to_string(i));
+            listPtr->addElement(i, std::to_string(i), false);
         }
         wm.activateWidget(listPtr->getId());
     }
@@ -0,0 +1,121 @@
+///
+///@file conslr/bitset.hpp
+///@brief Defines DynamicBitset, a resizable set of bits
+///
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Bits packed into 64 bit words, counts and whole set operations work a word at a time
+    ///
+    ///Bits past the size are always zero
+    ///
+    class DynamicBitset
+    {
+    public:
+        ///Resizes the set, new bits are zero
+        constexpr void resize(size_t size)
+        {
+            mWords.resize((size + 63) / 64, 0);
+            mSize = size;
+            clearPadding();
+
+            return;
+        }
+
+        constexpr void set(size_t index, bool value) noexcept
+        {
+            if (value)
+            {
+                mWords[index / 64] |= bit(index);
+            }
+            else
+            {
+                mWords[index / 64] &= ~bit(index);
+            }
+
+            return;
+        }
+
+        constexpr void setAll(bool value) noexcept
+        {
+            std::ranges::fill(mWords, value ? ~0ULL : 0ULL);
+            clearPadding();
+
+            return;
+        }
+
+        ///Keeps only the bits also set in other, which must be the same size
+        constexpr void intersect(const DynamicBitset& other) noexcept
+        {
+            for (size_t i = 0; i < mWords.size(); i++)
+            {
+                mWords[i] &= other.mWords[i];
+            }
+
+            return;
+        }
+
+        ///Flips the bits set in mask, which must be the same size
+        constexpr void flip(const DynamicBitset& mask) noexcept
+        {
+            for (size_t i = 0; i < mWords.size(); i++)
+            {
+                mWords[i] ^= mask.mWords[i];
+            }
+
+            return;
+        }
+
+        ///Calls fn with the index of every set bit, in increasing order
+        template <typename Fn>
+        constexpr void forEachSet(Fn&& fn) const
+        {
+            for (size_t i = 0; i < mWords.size(); i++)
+            {
+                for (uint64_t word = mWords[i]; word != 0; word &= word - 1)
+                {
+                    fn(i * 64 + (size_t)std::countr_zero(word));
+                }
+            }
+
+            return;
+        }
+
+        [[nodiscard]] constexpr bool test(size_t index) const noexcept { return index < mSize && (mWords[index / 64] & bit(index)) != 0; }
+        ///@return Number of set bits
+        [[nodiscard]] constexpr size_t count() const noexcept
+        {
+            size_t total = 0;
+            for (auto word : mWords)
+            {
+                total += (size_t)std::popcount(word);
+            }
+
+            return total;
+        }
+        [[nodiscard]] constexpr size_t size() const noexcept { return mSize; }
+
+    private:
+        [[nodiscard]] static constexpr uint64_t bit(size_t index) noexcept { return 1ULL << (index % 64); }
+
+        constexpr void clearPadding() noexcept
+        {
+            if (mSize % 64 != 0)
+            {
+                mWords.back() &= (1ULL << (mSize % 64)) - 1;
+            }
+
+            return;
+        }
+
+        std::vector<uint64_t> mWords;
+        size_t mSize = 0;
+    };
+}
@@ -0,0 +1,338 @@
+///
+///@file conslr/compressedlines.hpp
+///@brief Defines CompressedLineStore, block compressed storage for large amounts of text lines
+///
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Small LZ77 codec in the style of LZ4, fast to decompress and good enough for repetitive text such as logs
+    ///
+    ///A compressed block is a series of sequences, each a token byte (literal count << 4 | match length - 4),
+    ///the literals, then a 2 byte little endian offset back into the output and the match, the last sequence has no match
+    ///Counts of 15 or more continue in following bytes, each adding up to 255
+    ///
+    namespace lz
+    {
+        inline constexpr size_t MIN_MATCH = 4;
+        inline constexpr size_t MAX_OFFSET = 65535;
+        inline constexpr size_t HASH_BITS = 12;
+
+        namespace detail
+        {
+            inline uint32_t read32(const char* p) noexcept
+            {
+                uint32_t value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+
+            inline void writeCount(std::string& out, size_t count)
+            {
+                for (; count >= 255; count -= 255)
+                {
+                    out.push_back((char)255);
+                }
+                out.push_back((char)count);
+
+                return;
+            }
+
+            inline size_t readCount(std::string_view in, size_t& pos, size_t count)
+            {
+                if (count != 15)
+                {
+                    return count;
+                }
+
+                uint8_t byte;
+                do
+                {
+                    if (pos >= in.size())
+                    {
+                        throw std::runtime_error("Compressed data is truncated, size: " + std::to_string(in.size()));
+                    }
+                    byte = (uint8_t)in[pos++];
+                    count += byte;
+                } while (byte == 255);
+
+                return count;
+            }
+
+            inline void writeSequence(std::string& out, std::string_view literals, size_t offset, size_t matchLength)
+            {
+                size_t token = std::min<size_t>(literals.size(), 15) << 4;
+                if (offset != 0)
+                {
+                    token |= std::min<size_t>(matchLength - MIN_MATCH, 15);
+                }
+                out.push_back((char)token);
+
+                if (literals.size() >= 15)
+                {
+                    writeCount(out, literals.size() - 15);
+                }
+                out.append(literals);
+
+                if (offset != 0)
+                {
+                    out.push_back((char)(offset & 0xFF));
+                    out.push_back((char)(offset >> 8));
+                    if (matchLength - MIN_MATCH >= 15)
+                    {
+                        writeCount(out, matchLength - MIN_MATCH - 15);
+                    }
+                }
+
+                return;
+            }
+        }
+
+        ///@return in compressed
+        inline std::string compress(std::string_view in)
+        {
+            std::string out;
+            out.reserve(in.size() / 2 + 16);
+
+            //Last position + 1 of each hashed 4 byte sequence, 0 is empty
+            std::vector<uint32_t> table(1 << HASH_BITS, 0);
+            size_t anchor = 0;
+            size_t i = 0;
+            while (i + MIN_MATCH <= in.size())
+            {
+                uint32_t sequence = detail::read32(in.data() + i);
+                uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+                size_t candidate = table[hash];
+                table[hash] = (uint32_t)i + 1;
+
+                if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET || detail::read32(in.data() + candidate - 1) != sequence)
+                {
+                    i++;
+                    continue;
+                }
+                candidate--;
+
+                size_t length = MIN_MATCH;
+                while (i + length < in.size() && in[candidate + length] == in[i + length])
+                {
+                    length++;
+                }
+
+                detail::writeSequence(out, in.substr(anchor, i - anchor), i - candidate, length);
+                i += length;
+                anchor = i;
+            }
+
+            detail::writeSequence(out, in.substr(anchor), 0, 0);
+
+            return out;
+        }
+
+        ///Appends in decompressed to out
+        inline void decompress(std::string_view in, std::string& out)
+        {
+            size_t pos = 0;
+            while (pos < in.size())
+            {
+                uint8_t token = (uint8_t)in[pos++];
+
+                size_t literals = detail::readCount(in, pos, token >> 4);
+                if (pos + literals > in.size())
+                {
+                    throw std::runtime_error("Compressed data is truncated, size: " + std::to_string(in.size()));
+                }
+                out.append(in.substr(pos, literals));
+                pos += literals;
+
+                if (pos == in.size())
+                {
+                    break;
+                }
+
+                if (pos + 2 > in.size())
+                {
+                    throw std::runtime_error("Compressed data is truncated, size: " + std::to_string(in.size()));
+                }
+                size_t offset = (uint8_t)in[pos] | ((size_t)(uint8_t)in[pos + 1] << 8);
+                pos += 2;
+                size_t length = detail::readCount(in, pos, token & 0x0F) + MIN_MATCH;
+                if (offset == 0 || offset > out.size())
+                {
+                    throw std::runtime_error("Compressed data has an invalid offset, offset: " + std::to_string(offset));
+                }
+
+                //Matches may overlap the bytes they produce, so they are copied one at a time
+                size_t from = out.size() - offset;
+                for (size_t i = 0; i < length; i++)
+                {
+                    out.push_back(out[from + i]);
+                }
+            }
+
+            return;
+        }
+    }
+
+    ///
+    ///Stores lines in blocks of LINES_PER_BLOCK, every full block is compressed with lz
+    ///
+    ///Lines are found in O(1) by their block, and only the few blocks read most recently are kept decompressed
+    ///Once more than maxLines are stored, the oldest block is dropped, so the limit is kept to a multiple of LINES_PER_BLOCK
+    ///
+    class CompressedLineStore
+    {
+    public:
+        static constexpr size_t LINES_PER_BLOCK = 256;
+
+        ///@param maxLines Lines kept before the oldest block is dropped, 0 for no limit
+        ///@param cachedBlocks Number of decompressed blocks kept
+        explicit CompressedLineStore(size_t maxLines = 0, size_t cachedBlocks = 4) :
+            mMaxLines{ maxLines }, mCache(std::max<size_t>(cachedBlocks, 1))
+        {}
+
+        ///Appends a line
+        ///
+        ///@return Number of old lines dropped
+        size_t push(std::string_view line)
+        {
+            mOpen.offsets.push_back((uint32_t)mOpen.text.size());
+            mOpen.text.append(line);
+            mCount++;
+
+            if (mOpen.offsets.size() < LINES_PER_BLOCK)
+            {
+                return 0;
+            }
+
+            //Seals the block, offsets go first so one decompression gives both
+            std::string payload((char*)mOpen.offsets.data(), mOpen.offsets.size() * sizeof(uint32_t));
+            payload.append(mOpen.text);
+            mBlocks.push_back(lz::compress(payload));
+            mCompressedSize += mBlocks.back().size();
+            mOpen.offsets.clear();
+            mOpen.text.clear();
+
+            if (mMaxLines == 0 || mCount <= mMaxLines)
+            {
+                return 0;
+            }
+
+            mCompressedSize -= mBlocks.front().size();
+            mBlocks.pop_front();
+            mFirstBlock++;
+            mCount -= LINES_PER_BLOCK;
+
+            return LINES_PER_BLOCK;
+        }
+
+        void clear()
+        {
+            //Numbers keep increasing so cached blocks are never mistaken for new ones
+            mFirstBlock += mBlocks.size();
+            mBlocks.clear();
+            mOpen.offsets.clear();
+            mOpen.text.clear();
+            mCount = 0;
+            mCompressedSize = 0;
+
+            return;
+        }
+
+        ///@param index Index of the line, 0 is the oldest line kept
+        ///@return The line, valid until the next call
+        [[nodiscard]] std::string_view operator[](size_t index)
+        {
+            size_t block = index / LINES_PER_BLOCK;
+            size_t line = index % LINES_PER_BLOCK;
+            if (block == mBlocks.size())
+            {
+                return mOpen.getLine(line);
+            }
+
+            return getBlock(mFirstBlock + block).getLine(line);
+        }
+        [[nodiscard]] std::string_view at(size_t index)
+        {
+            if (index >= mCount)
+            {
+                throw std::out_of_range("Line index is out of bounds, index: " + std::to_string(index) + ", size: " + std::to_string(mCount));
+            }
+
+            return (*this)[index];
+        }
+
+        [[nodiscard]] constexpr size_t size() const noexcept { return mCount; }
+        ///@return Bytes of compressed text
+        [[nodiscard]] constexpr size_t getCompressedSize() const noexcept { return mCompressedSize; }
+
+    private:
+        struct Block
+        {
+            std::vector<uint32_t> offsets; //!<Start of each line in text
+            std::string text;
+
+            [[nodiscard]] std::string_view getLine(size_t line) const
+            {
+                size_t end = line + 1 < offsets.size() ? offsets[line + 1] : text.size();
+                return std::string_view{ text }.substr(offsets[line], end - offsets[line]);
+            }
+        };
+
+        struct CacheEntry
+        {
+            size_t block = SIZE_MAX; //!<Number of the block counting dropped blocks
+            uint64_t lastUse = 0;
+            Block data;
+        };
+
+        Block& getBlock(size_t block)
+        {
+            mUseCounter++;
+
+            CacheEntry* oldest = &mCache.front();
+            for (auto& entry : mCache)
+            {
+                if (entry.block == block)
+                {
+                    entry.lastUse = mUseCounter;
+                    return entry.data;
+                }
+                if (entry.lastUse < oldest->lastUse)
+                {
+                    oldest = &entry;
+                }
+            }
+
+            std::string payload;
+            lz::decompress(mBlocks[block - mFirstBlock], payload);
+
+            oldest->block = block;
+            oldest->lastUse = mUseCounter;
+            oldest->data.offsets.resize(LINES_PER_BLOCK);
+            std::memcpy(oldest->data.offsets.data(), payload.data(), LINES_PER_BLOCK * sizeof(uint32_t));
+            oldest->data.text.assign(payload, LINES_PER_BLOCK * sizeof(uint32_t));
+
+            return oldest->data;
+        }
+
+        size_t mMaxLines;
+        std::deque<std::string> mBlocks; //!<Compressed full blocks, oldest first
+        size_t mFirstBlock = 0; //!<Number of the block at the front of mBlocks
+        Block mOpen; //!<Newest block, not full so not compressed yet
+        size_t mCount = 0;
+        size_t mCompressedSize = 0;
+
+        std::vector<CacheEntry> mCache;
+        uint64_t mUseCounter = 0;
+    };
+}
@@ -5,11 +5,11 @@
 #pragma once
 
 #include <cstdint>
-#include <array>
-#include <queue>
+#include <vector>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 #include <SDL.h>
 
@@ -35,9 +35,13 @@ namespace conslr
         ///
         ///@return true is screen is still valid, false if screen was closed
         bool doEvent(SDL_Event& event);
+        ///Applies input held back by event coalescing, called at the start of render
+        void flushEvents();
         void render();
 
+        ///Creates a screen, reusing the allocations of a destroyed screen when one is available
         [[nodiscard]] int32_t createScreen();
+        ///Destroys a screen, its widgets are destroyed and its cells kept for the next createScreen
         void destroyScreen(int32_t index);
 
         [[nodiscard]] int32_t createFont(const std::string& file, int32_t charWidth, int32_t charHeight);
@@ -52,7 +56,7 @@ namespace conslr
         [[nodiscard]] constexpr int32_t getCurrentFontIndex() const noexcept { return mCurrentFont; }
         [[nodiscard]] WidgetManager& getWidgetManager(int32_t index) const
         {
-            if (!(index >= 0 && index < MAX_SCREENS))
+            if (!(index >= 0 && (size_t)index < mScreens.size()))
             {
                 throw std::invalid_argument("Screen index is out of bounds, index: " + std::to_string(index));
             }
@@ -63,8 +67,25 @@ namespace conslr
 
             return mScreens.at(index)->mWidgetManager;
         }
+        ///Gets the widget counts from the last time the screen was rendered
+        [[nodiscard]] const Screen::FrameStats& getFrameStats(int32_t index) const
+        {
+            if (!(index >= 0 && (size_t)index < mScreens.size()))
+            {
+                throw std::invalid_argument("Screen index is out of bounds, index: " + std::to_string(index));
+            }
+            if (mScreens.at(index) == nullptr)
+            {
+                throw std::runtime_error("Screen at index is already nullptr, index: " + std::to_string(index));
+            }
+
+            return mScreens.at(index)->getFrameStats();
+        }
         [[nodiscard]] std::weak_ptr<Theme> getTheme() const noexcept { return mTheme; }
         [[nodiscard]] constexpr const KeyMapping& getKeyMap() const noexcept { return mKeyMap; }
+        [[nodiscard]] constexpr bool getEventRouting() const noexcept { return mEventRouting; }
+        [[nodiscard]] constexpr bool getEventCoalescing() const noexcept { return mEventCoalescing; }
+        [[nodiscard]] constexpr bool getScreenCaching() const noexcept { return mScreenCaching; }
         [[nodiscard]] int32_t getWindowId() const noexcept { return SDL_GetWindowID(mWindow.get()); }
 
         //Setters
@@ -79,20 +100,58 @@ namespace conslr
             mCurrentFont = index; 
         }
         void setTheme(const Theme& theme) noexcept;
-        constexpr void setKeyMap(const KeyMapping& keyMap) noexcept { mKeyMap = keyMap; }
+        void setKeyMap(const KeyMapping& keyMap);
+        ///When enabled, doEvent delivers key and text input events to the focused widget of the current screen
+        ///
+        ///Keys are matched against the KeyMapping, the tab key moves focus unless the focused widget takes text input
+        constexpr void setEventRouting(bool val) noexcept { mEventRouting = val; }
+        ///When enabled, routed input is merged and applied once per frame instead of once per event
+        ///
+        ///Repeated scrolling becomes a single scrollBy, consecutive text input a single insertText,
+        ///and mouse motion only reports the last position. Input is applied in the order it arrived,
+        ///held back input is flushed by every event that is not coalesced and when a screen is destroyed,
+        ///text is only held back for an active widget and is inserted even if the widget loses focus before the flush
+        void setEventCoalescing(bool val) { if (!val) { flushEvents(); } mEventCoalescing = val; }
+        ///When enabled, each screen keeps a texture of its last render and render copies it to the window
+        ///
+        ///Frames where the current screen has not changed are used to redraw the texture of one changed background screen,
+        ///so switching to it is a single texture copy. Falls back to drawing cells if the renderer cannot render to textures
+        void setScreenCaching(bool val) noexcept;
         void setTitle(const std::string& str) noexcept { SDL_SetWindowTitle(mWindow.get(), str.c_str()); }
         void setIcon(SDL_Surface* icon) noexcept { SDL_SetWindowIcon(mWindow.get(), icon); }
 
-        //Const values
-        static const int32_t MAX_SCREENS = 16; //!<Max screens that a console can have
-        static const int32_t MAX_FONTS = 4; //!<Max fonts that a console can have
-
     private:
         ///Destroys the console
         ///
         ///Used for destroying a window when there are multiple windows
         void destroy();
 
+        ///Routes a mouse event to the widget under the cursor on the current screen
+        void doMouseEvent(SDL_Event& event);
+        ///Scrolls the widget under the cursor
+        void doMouseWheel(const WidgetManager::WidgetInterfaces& interfaces, SDL_MouseWheelEvent& wheel);
+        ///Routes a key or text input event to the focused widget on the current screen
+        void doRoutedEvent(SDL_Event& event);
+        ///@return Action mapped to the key, KeyAction::None if there is none
+        [[nodiscard]] KeyAction findKeyAction(const SDL_KeyboardEvent& key) const noexcept;
+        ///@return True if the event can be merged into mPending instead of flushing it
+        [[nodiscard]] bool isCoalesced(const SDL_Event& event) const noexcept;
+        ///Rebuilds mKeyActions from mKeyMap
+        void buildKeyActions();
+        ///Renders the screen if it or any of its widgets need it
+        ///
+        ///@return True if the screen was rendered
+        bool updateScreen(Screen& scr);
+        ///Draws the cells of a screen to the current render target
+        void drawCells(const Screen& scr);
+        ///Redraws the cached texture of a screen if it is out of date
+        ///
+        ///@param changed True if the screen was rendered since its texture was drawn
+        ///@return Texture of the screen, or nullptr if textures can not be used
+        SDL_Texture* updateScreenCache(int32_t index, bool changed);
+        ///Renders a changed background screen and redraws its texture
+        void prerenderScreen();
+
         //Console data
         int32_t mCellWidth;
         int32_t mCellHeight;
@@ -101,17 +160,59 @@ namespace conslr
         int32_t mWindowWidth;
         int32_t mWindowHeight;
         std::shared_ptr<Theme> mTheme;
+        uint32_t mThemeVersion; //!<Incremented by setTheme
 
         //SDL data
         std::unique_ptr<SDL_Window, decltype(&SDL_DestroyWindow)> mWindow;
         std::unique_ptr<SDL_Renderer, decltype(&SDL_DestroyRenderer)> mRenderer;
         KeyMapping mKeyMap;
+        std::unordered_map<uint32_t, KeyAction> mKeyActions; //!<Scancode in the high 16 bits and modifiers without LOCK_MODIFIERS in the low 16 bits to action
+        bool mEventRouting;
+
+        //Coalesced input waiting for flushEvents
+        enum class PendingKind
+        {
+            None,
+            Motion,
+            Wheel,
+            Scroll,
+            Text
+        };
+        struct PendingInput
+        {
+            PendingKind kind = PendingKind::None;
+            int32_t screen = -1;
+            int32_t target = -1; //!<Widget id, motion looks its target up when flushed
+            int32_t scroll = 0;
+            SDL_MouseWheelEvent wheel{};
+            std::string text;
+        };
+        PendingInput mPending;
+        bool mEventCoalescing;
+
+        //Mouse position in cells
+        int32_t mMouseX;
+        int32_t mMouseY;
 
         //Screen data
-        std::queue<int32_t> mFreeScreens;
-        std::array<std::unique_ptr<Screen>, MAX_SCREENS> mScreens;
+        std::vector<int32_t> mFreeScreens;
+        std::vector<std::unique_ptr<Screen>> mScreens; //!<Indices stay valid until the screen is destroyed
+        std::vector<std::unique_ptr<Screen>> mRecycledScreens; //!<Destroyed screens kept to reuse their cell allocations
         int32_t mCurrentScreen;
 
+        //Screen textures, same indices as mScreens
+        struct ScreenCache
+        {
+            std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)> texture{ nullptr, SDL_DestroyTexture };
+            int32_t width = 0; //!<Size in pixels the texture was created with
+            int32_t height = 0;
+            int32_t font = -1; //!<Font the texture was drawn with
+            bool valid = false;
+        };
+        std::vector<ScreenCache> mScreenCaches;
+        bool mScreenCaching;
+        int32_t mNextPrerender; //!<Screen index to look at first when prerendering
+
         //Font data
         struct Font
         {
@@ -128,8 +229,8 @@ namespace conslr
 
             std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)> mTexture; 
         };
-        std::queue<int32_t> mFreeFonts;
-        std::array<std::unique_ptr<Font>, MAX_FONTS> mFonts;
+        std::vector<int32_t> mFreeFonts;
+        std::vector<std::unique_ptr<Font>> mFonts;
         int32_t mCurrentFont;
     };
 }
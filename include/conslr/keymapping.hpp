@@ -10,6 +10,9 @@ struct ExtendedMapping;
 
 namespace conslr
 {
+    ///Modifiers that stay on after the key is released, ignored when keys are matched so bindings work with caps lock or num lock on
+    inline constexpr uint16_t LOCK_MODIFIERS = KMOD_NUM | KMOD_CAPS | KMOD_MODE | KMOD_SCROLL;
+
     struct KeyPair
     {
         SDL_Scancode scancode;
@@ -17,10 +20,23 @@ namespace conslr
 
         friend constexpr bool operator==(const KeyPair& keyPair, const SDL_Keysym& keySym) noexcept
         {
-            return (keyPair.scancode == keySym.scancode) && (keyPair.mod == keySym.mod);
+            return (keyPair.scancode == keySym.scancode) && ((keyPair.mod & ~LOCK_MODIFIERS) == (keySym.mod & ~LOCK_MODIFIERS));
         }
     };
 
+    ///Actions that keys in a KeyMapping are bound to
+    enum class KeyAction
+    {
+        None,
+        ScrollUp,
+        ScrollDown,
+        ScrollLeft,
+        ScrollRight,
+        Tab,
+        Enter,
+        Backspace
+    };
+
     struct KeyMapping
     {
         KeyPair scrollUp = { SDL_SCANCODE_UP, KMOD_NONE }; //!<Scroll up
@@ -0,0 +1,138 @@
+///
+///@file conslr/linebuffer.hpp
+///@brief Defines LineRingBuffer, a fixed size store of the most recent lines of text
+///
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Keeps the most recent lines of text in one arena, dropping the oldest lines when it is full
+    ///
+    ///The arena is used as a ring, a line that does not fit before its end starts over at the beginning
+    ///Appending never allocates, memory use is fixed by the line and byte capacities
+    ///
+    class LineRingBuffer
+    {
+    public:
+        ///@param maxLines Lines kept before the oldest is dropped
+        ///@param arenaSize Bytes of text kept before the oldest lines are dropped
+        LineRingBuffer(size_t maxLines, size_t arenaSize) :
+            mArena(arenaSize), mLines(maxLines)
+        {
+            if (maxLines == 0 || arenaSize == 0)
+            {
+                throw std::invalid_argument("LineRingBuffer capacities must be greater than 0, maxLines: " + std::to_string(maxLines) + ", arenaSize: " + std::to_string(arenaSize));
+            }
+        }
+
+        ///Appends a line, lines longer than the arena are truncated
+        ///
+        ///@return Number of old lines dropped to make room
+        size_t push(std::string_view line) { return push(line, [](std::string_view) {}); }
+        ///Appends a line, lines longer than the arena are truncated
+        ///
+        ///@param onDrop Called with each old line before it is dropped to make room
+        ///@return Number of old lines dropped to make room
+        template <typename DropFn>
+        size_t push(std::string_view line, DropFn&& onDrop)
+        {
+            size_t length = std::min(line.size(), mArena.size());
+            size_t dropped = 0;
+
+            if (mCount == mLines.size())
+            {
+                onDrop((*this)[0]);
+                popFront();
+                dropped++;
+            }
+
+            //Positions only increase, a line that would cross the end of the arena starts at the next multiple of its size instead
+            uint64_t start = mHead;
+            if (start % mArena.size() + length > mArena.size())
+            {
+                start += mArena.size() - start % mArena.size();
+            }
+
+            //The span from the oldest line to the end of the new one, including skipped bytes, must fit in the arena
+            while (mCount != 0 && start + length - mLines[mFirst].start > mArena.size())
+            {
+                onDrop((*this)[0]);
+                popFront();
+                dropped++;
+            }
+
+            if (length != 0)
+            {
+                std::memcpy(mArena.data() + start % mArena.size(), line.data(), length);
+            }
+            mLines[(mFirst + mCount) % mLines.size()] = { start, length };
+            mCount++;
+            mHead = start + length;
+            mDropped += dropped;
+
+            return dropped;
+        }
+
+        void clear() noexcept
+        {
+            mDropped += mCount;
+            mFirst = 0;
+            mCount = 0;
+
+            return;
+        }
+
+        ///@param index Index of the line, 0 is the oldest line kept
+        [[nodiscard]] std::string_view operator[](size_t index) const
+        {
+            const auto& line = mLines[(mFirst + index) % mLines.size()];
+            return { mArena.data() + line.start % mArena.size(), line.length };
+        }
+        [[nodiscard]] std::string_view at(size_t index) const
+        {
+            if (index >= mCount)
+            {
+                throw std::out_of_range("Line index is out of bounds, index: " + std::to_string(index) + ", size: " + std::to_string(mCount));
+            }
+
+            return (*this)[index];
+        }
+
+        [[nodiscard]] constexpr size_t size() const noexcept { return mCount; }
+        [[nodiscard]] constexpr bool empty() const noexcept { return mCount == 0; }
+        [[nodiscard]] size_t getMaxLines() const noexcept { return mLines.size(); }
+        [[nodiscard]] size_t getArenaSize() const noexcept { return mArena.size(); }
+        ///@return Number of lines dropped since construction, the line at index 0 is line getDropped() of everything pushed
+        [[nodiscard]] constexpr uint64_t getDropped() const noexcept { return mDropped; }
+
+    private:
+        struct Line
+        {
+            uint64_t start; //!<Position in the arena counting every byte ever written, the offset is start % arena size
+            size_t length;
+        };
+
+        void popFront() noexcept
+        {
+            mFirst = (mFirst + 1) % mLines.size();
+            mCount--;
+
+            return;
+        }
+
+        std::vector<char> mArena;
+        std::vector<Line> mLines; //!<Ring of lines, oldest at mFirst
+        size_t mFirst = 0;
+        size_t mCount = 0;
+        uint64_t mHead = 0; //!<Position after the newest line
+        uint64_t mDropped = 0;
+    };
+}
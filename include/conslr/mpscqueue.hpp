@@ -0,0 +1,92 @@
+///
+///@file conslr/mpscqueue.hpp
+///@brief Defines MpscQueue, a lock-free queue for handing values to the render thread
+///
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace conslr
+{
+    ///
+    ///Lock-free multiple producer, single consumer queue
+    ///
+    ///Producers push onto an atomic stack, the consumer takes the whole stack with one exchange and reverses it,
+    ///so values come out in the order they were pushed
+    ///
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        MpscQueue() = default;
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+        ~MpscQueue()
+        {
+            deleteNodes(mHead.exchange(nullptr, std::memory_order_acquire));
+        }
+
+        ///Safe to call from any thread
+        void push(T value)
+        {
+            Node* node = new Node{ std::move(value), mHead.load(std::memory_order_relaxed) };
+            while (!mHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+
+            return;
+        }
+
+        ///Calls fn with every queued value, oldest first, only one thread may drain at a time
+        ///
+        ///@return Number of values drained
+        template <typename Fn>
+        size_t drain(Fn&& fn)
+        {
+            Node* node = mHead.exchange(nullptr, std::memory_order_acquire);
+
+            //The stack is newest first
+            Node* reversed = nullptr;
+            while (node != nullptr)
+            {
+                Node* next = node->next;
+                node->next = reversed;
+                reversed = node;
+                node = next;
+            }
+
+            size_t count = 0;
+            for (node = reversed; node != nullptr; count++)
+            {
+                fn(std::move(node->value));
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+
+            return count;
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return mHead.load(std::memory_order_relaxed) == nullptr; }
+
+    private:
+        struct Node
+        {
+            T value;
+            Node* next;
+        };
+
+        static void deleteNodes(Node* node)
+        {
+            while (node != nullptr)
+            {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+
+            return;
+        }
+
+        std::atomic<Node*> mHead = nullptr;
+    };
+}
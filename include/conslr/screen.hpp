@@ -5,15 +5,24 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include <version>
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
 
 #include <SDL_pixels.h>
+#include <SDL_rect.h>
 
 #include <conslr/widgetmanager.hpp>
 #include <conslr/taggedstring.hpp>
 
 struct SDL_Renderer;
-struct SDL_Rect;
 union SDL_Event;
 
 namespace conslr
@@ -33,6 +42,14 @@ namespace conslr
     public:
         friend class conslr::Console;
 
+        ///Widget counts from the last call to render
+        struct FrameStats
+        {
+            int32_t rendered = 0; //!<Widgets that were rendered
+            int32_t culledOffscreen = 0; //!<Widgets skipped because their region is entirely outside the screen
+            int32_t culledOccluded = 0; //!<Widgets skipped because opaque widgets above them cover their region
+        };
+
         Screen() = delete;
 
         void render();
@@ -57,32 +74,150 @@ namespace conslr
 
         void borderRect(SDL_Rect rect, uint8_t horizontal, uint8_t vertical, uint8_t cornerTl, uint8_t cornerTr, uint8_t cornerBl, uint8_t cornerBr);
 
-        void renderText(int32_t x, int32_t y, int32_t maxSize, const std::string& str);
-        void renderMultilineText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str);
-        void renderTextColor(int32_t x, int32_t y, int32_t maxSize, const std::string& str, const SDL_Color& color);
-        void renderTextColor(int32_t x, int32_t y, int32_t maxSize, const std::string& str, const SDL_Color& foreground, const SDL_Color& background);
-        void renderTextTagged(int32_t x, int32_t y, int32_t maxSize, const TaggedString& str, const TagSet& tags);
-        void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& color);
-        void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& foreground, const SDL_Color& background);
-        void renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const TaggedString& str, const TagSet& tags);
+        void renderText(int32_t x, int32_t y, int32_t maxSize, std::string_view str);
+        void renderMultilineText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str);
+        void renderTextColor(int32_t x, int32_t y, int32_t maxSize, std::string_view str, const SDL_Color& color);
+        void renderTextColor(int32_t x, int32_t y, int32_t maxSize, std::string_view str, const SDL_Color& foreground, const SDL_Color& background);
+        void renderTextTagged(int32_t x, int32_t y, int32_t maxSize, std::span<const TaggedChar> str, const TagSet& tags);
+        void renderTextTagged(int32_t x, int32_t y, int32_t maxSize, const TaggedString& str, const TagSet& tags) { renderTextTagged(x, y, maxSize, std::span<const TaggedChar>{ str.str }, tags); }
+        void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str, const SDL_Color& color);
+        void renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str, const SDL_Color& foreground, const SDL_Color& background);
+        void renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::span<const TaggedChar> str, const TagSet& tags);
+        void renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const TaggedString& str, const TagSet& tags)
+        {
+            renderMultilineTextTagged(x, y, maxWidth, maxHeight, std::span<const TaggedChar>{ str.str }, tags);
+        }
+
+#if defined(__cpp_lib_format)
+        ///Formats text straight into the cells of a row, characters past the edge of the screen are dropped
+        ///
+        ///Only the characters of the cells are changed, like renderText
+        template<typename... Args>
+        void print(int32_t x, int32_t y, std::format_string<Args...> fmt, Args&&... args)
+        {
+            std::format_to(CellIterator{ *this, x, y }, fmt, std::forward<Args>(args)...);
+
+            mRerender = true;
+
+            return;
+        }
+#endif
 
         //Getters
         [[nodiscard]] const int32_t& getWidth() const { return mWidth; }
         [[nodiscard]] const int32_t& getHeight() const { return mHeight; }
         [[nodiscard]] const std::vector<Cell>& getCells() const { return mCells; }
+        [[nodiscard]] const FrameStats& getFrameStats() const noexcept { return mFrameStats; }
+        ///Gets the id of the topmost visible widget whose region contains the cell
+        ///
+        ///Reflects the layout as of the last render
+        ///
+        ///@return Widget id, or -1 if no widget is at the cell
+        [[nodiscard]] int32_t getWidgetAt(int32_t x, int32_t y) const noexcept
+        {
+            if (x < 0 || x >= mWidth || y < 0 || y >= mHeight) { return -1; }
+
+            return mOwners[(y * mWidth) + x];
+        }
 
         bool mRerender;
         WidgetManager mWidgetManager;
 
     private:
+        ///Output iterator writing characters to consecutive cells of a row
+        class CellIterator
+        {
+        public:
+            using iterator_category = std::output_iterator_tag;
+            using value_type = void;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = void;
+
+            constexpr CellIterator(Screen& screen, int32_t x, int32_t y) noexcept :
+                mScreen{ &screen }, mX{ x }, mY{ y }
+            {}
+
+            constexpr CellIterator& operator*() noexcept { return *this; }
+            constexpr CellIterator& operator++() noexcept { mX++; return *this; }
+            constexpr CellIterator operator++(int) noexcept { CellIterator old = *this; mX++; return old; }
+            constexpr CellIterator& operator=(char c) noexcept
+            {
+                if (mX >= 0 && mX < mScreen->mWidth && mY >= 0 && mY < mScreen->mHeight)
+                {
+                    mScreen->mCells[(mY * mScreen->mWidth) + mX].character = (unsigned char)c;
+                }
+
+                return *this;
+            }
+
+        private:
+            Screen* mScreen;
+            int32_t mX;
+            int32_t mY;
+        };
+
         Screen(int32_t width, int32_t height);
 
+        ///Which cell colors text output sets, the character is always set
+        enum class TextColor
+        {
+            None,
+            Foreground,
+            ForegroundBackground,
+            Tagged //!<Foreground and background come from the tags of each TaggedChar
+        };
+        struct TextStyle
+        {
+            const SDL_Color* foreground;
+            const SDL_Color* background;
+            const TagSet* tags;
+        };
+        ///Writes count characters to a row, clipped to the screen
+        template<TextColor Color, typename CharT>
+        void writeRow(int32_t x, int32_t y, const CharT* str, int32_t count, const TextStyle& style) noexcept;
+        ///Splits text into rows at newlines and every maxWidth characters and writes the rows that are on screen
+        template<TextColor Color, typename CharT>
+        void layoutText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::span<const CharT> str, const TextStyle& style) noexcept;
+
+        ///Returns the screen to its newly created state without freeing its allocations
+        void reset();
         void clear();
+        ///Fills mDrawList with the visible widgets that are not culled, in reverse render order
+        void cull();
+        ///Updates the grid index and cell owners for widgets whose regions changed since the last update
+        void updateLayout();
+        ///Recomputes the owner of every cell in rect from the grid index
+        void updateOwners(SDL_Rect rect);
+        void gridInsert(int32_t position, const SDL_Rect& region);
+        void gridErase(int32_t position, const SDL_Rect& region);
+
+        uint32_t mThemeVersion; //!<Console theme version the screen was last rendered with
 
         //Size in cells
         int32_t mWidth;
         int32_t mHeight;
 
         std::vector<Cell> mCells;
+
+        //Culling data
+        std::vector<uint8_t> mCoverage; //!<Cells covered by opaque widgets during culling
+        std::vector<IRenderable*> mDrawList;
+        FrameStats mFrameStats;
+
+        //Hit testing data
+        struct LayoutEntry
+        {
+            int32_t id;
+            SDL_Rect region;
+        };
+        std::vector<LayoutEntry> mLayout; //!<Visible widgets with a region, in render order
+        std::vector<LayoutEntry> mNextLayout;
+        std::vector<std::vector<int32_t>> mGrid; //!<Layout positions overlapping each bucket, sorted in render order
+        int32_t mGridWidth;
+        int32_t mGridHeight;
+        std::vector<int32_t> mOwners; //!<Topmost widget id per cell, -1 for none
+
+        static const int32_t GRID_SIZE = 8; //!<Width and height in cells of a grid bucket
     };
 }
@@ -0,0 +1,358 @@
+///
+///@file conslr/textrows.hpp
+///@brief Defines TextRows, the row store behind TextInput
+///
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Rows of editable text, indexed by row in O(log n)
+    ///
+    ///Text given to assign is kept in one buffer that is never changed, rows point into it until they are edited
+    ///and only then get their own string, the same idea as the original buffer of a piece table
+    ///Rows are kept in chunks of about CHUNK_ROWS with a Fenwick tree over the chunk sizes, so inserting, erasing and
+    ///finding a row only touches one chunk
+    ///Row lengths are counted, so the longest row is known without a scan
+    ///
+    class TextRows
+    {
+    public:
+        static constexpr size_t CHUNK_ROWS = 512;
+
+        TextRows() { assign(std::string{}); }
+
+        ///Replaces every row, text is split into rows at newlines
+        void assign(std::string text)
+        {
+            mOriginal = std::move(text);
+            mEdited.clear();
+            mFreeEdited.clear();
+            mChunks.clear();
+            mLengths.clear();
+            mSize = 0;
+            mBytes = 0;
+
+            mChunks.emplace_back();
+            size_t start = 0;
+            while (true)
+            {
+                const char* newline = (const char*)std::memchr(mOriginal.data() + start, '\n', mOriginal.size() - start);
+                size_t end = newline == nullptr ? mOriginal.size() : (size_t)(newline - mOriginal.data());
+
+                if (mChunks.back().size() == CHUNK_ROWS)
+                {
+                    mChunks.emplace_back();
+                }
+                mChunks.back().push_back({ start, (uint32_t)(end - start), 0 });
+                countLength(end - start, 1);
+                mSize++;
+                mBytes += end - start;
+
+                if (newline == nullptr)
+                {
+                    break;
+                }
+                start = end + 1;
+            }
+            rebuildTree();
+
+            return;
+        }
+
+        ///Inserts text into a row, text should not contain newlines
+        void insertText(size_t row, size_t column, std::string_view text)
+        {
+            std::string& str = ownRow(row);
+            countLength(str.size(), -1);
+            str.insert(std::min(column, str.size()), text);
+            countLength(str.size(), 1);
+            mBytes += text.size();
+
+            return;
+        }
+        ///Erases up to count characters from a row
+        void eraseText(size_t row, size_t column, size_t count)
+        {
+            std::string& str = ownRow(row);
+            countLength(str.size(), -1);
+            size_t erased = std::min(count, str.size() - std::min(column, str.size()));
+            str.erase(std::min(column, str.size()), erased);
+            countLength(str.size(), 1);
+            mBytes -= erased;
+
+            return;
+        }
+        ///Moves the text of a row after column to a new row after it
+        void splitRow(size_t row, size_t column)
+        {
+            std::string& str = ownRow(row);
+            column = std::min(column, str.size());
+            std::string tail = str.substr(column);
+            countLength(str.size(), -1);
+            str.erase(column);
+            countLength(str.size(), 1);
+
+            //The moved text is counted again by insertRow
+            mBytes -= tail.size();
+            insertRow(row + 1, std::move(tail));
+
+            return;
+        }
+        ///Appends the row after row to it and removes that row
+        void joinRow(size_t row)
+        {
+            if (row + 1 >= mSize)
+            {
+                throw std::out_of_range("There is no row to join, row: " + std::to_string(row) + ", size: " + std::to_string(mSize));
+            }
+
+            std::string next{ (*this)[row + 1] };
+            eraseRow(row + 1);
+            insertText(row, std::string::npos, next);
+
+            return;
+        }
+        ///Inserts a row before row
+        void insertRow(size_t row, std::string text)
+        {
+            auto [chunk, index] = locate(std::min(row, mSize), true);
+
+            countLength(text.size(), 1);
+            mBytes += text.size();
+            mChunks[chunk].insert(mChunks[chunk].begin() + index, { 0, 0, allocateEdited(std::move(text)) });
+            mSize++;
+
+            if (mChunks[chunk].size() > CHUNK_ROWS * 2)
+            {
+                std::vector<Row> half{ mChunks[chunk].begin() + CHUNK_ROWS, mChunks[chunk].end() };
+                mChunks[chunk].resize(CHUNK_ROWS);
+                mChunks.insert(mChunks.begin() + chunk + 1, std::move(half));
+                rebuildTree();
+            }
+            else
+            {
+                treeAdd(chunk, 1);
+            }
+
+            return;
+        }
+        void eraseRow(size_t row)
+        {
+            if (mSize == 1)
+            {
+                throw std::out_of_range("The last row can not be erased");
+            }
+
+            auto [chunk, index] = locate(row, false);
+            Row& erased = mChunks[chunk][index];
+            size_t length = getLength(erased);
+            countLength(length, -1);
+            mBytes -= length;
+            if (erased.edited != 0)
+            {
+                mEdited[erased.edited - 1] = {};
+                mFreeEdited.push_back(erased.edited - 1);
+            }
+            mChunks[chunk].erase(mChunks[chunk].begin() + index);
+            mSize--;
+
+            //Merges small chunks so the chunk count stays proportional to the row count
+            if (mChunks[chunk].size() < CHUNK_ROWS / 4 && mChunks.size() > 1)
+            {
+                size_t into = chunk == 0 ? 0 : chunk - 1;
+                if (mChunks[into].size() + mChunks[into + 1].size() <= CHUNK_ROWS * 2)
+                {
+                    mChunks[into].insert(mChunks[into].end(), mChunks[into + 1].begin(), mChunks[into + 1].end());
+                    mChunks.erase(mChunks.begin() + into + 1);
+                    rebuildTree();
+                    return;
+                }
+            }
+            treeAdd(chunk, -1);
+
+            return;
+        }
+        ///Erases every row from count on
+        void truncate(size_t count)
+        {
+            while (mSize > std::max<size_t>(count, 1))
+            {
+                eraseRow(mSize - 1);
+            }
+
+            return;
+        }
+
+        ///Calls fn with every row in order
+        template <typename Fn>
+        void forEachRow(Fn&& fn) const
+        {
+            for (const auto& chunk : mChunks)
+            {
+                for (const auto& row : chunk)
+                {
+                    fn(getText(row));
+                }
+            }
+
+            return;
+        }
+
+        [[nodiscard]] std::string_view operator[](size_t row) const { return getText(getRow(row)); }
+        [[nodiscard]] std::string_view at(size_t row) const
+        {
+            if (row >= mSize)
+            {
+                throw std::out_of_range("Row index is out of bounds, row: " + std::to_string(row) + ", size: " + std::to_string(mSize));
+            }
+
+            return (*this)[row];
+        }
+        [[nodiscard]] constexpr size_t size() const noexcept { return mSize; }
+        ///@return Number of characters in every row, not counting newlines
+        [[nodiscard]] constexpr size_t getByteSize() const noexcept { return mBytes; }
+        ///@return Length of the longest row
+        [[nodiscard]] size_t getMaxWidth() const noexcept { return mLengths.empty() ? 0 : mLengths.rbegin()->first; }
+
+    private:
+        struct Row
+        {
+            size_t start; //!<Start in mOriginal
+            uint32_t length; //!<Length in mOriginal
+            uint32_t edited; //!<Index + 1 of the row's string in mEdited, 0 if the row is still in mOriginal
+        };
+
+        [[nodiscard]] std::string_view getText(const Row& row) const
+        {
+            if (row.edited != 0)
+            {
+                return mEdited[row.edited - 1];
+            }
+
+            return std::string_view{ mOriginal }.substr(row.start, row.length);
+        }
+        [[nodiscard]] size_t getLength(const Row& row) const { return row.edited != 0 ? mEdited[row.edited - 1].size() : row.length; }
+
+        [[nodiscard]] const Row& getRow(size_t row) const
+        {
+            auto [chunk, index] = locate(row, false);
+            return mChunks[chunk][index];
+        }
+        [[nodiscard]] Row& getRow(size_t row)
+        {
+            auto [chunk, index] = locate(row, false);
+            return mChunks[chunk][index];
+        }
+
+        ///Copies a row out of mOriginal if it is still there
+        std::string& ownRow(size_t row)
+        {
+            Row& r = getRow(row);
+            if (r.edited == 0)
+            {
+                r.edited = allocateEdited(std::string{ getText(r) });
+            }
+
+            return mEdited[r.edited - 1];
+        }
+
+        uint32_t allocateEdited(std::string text)
+        {
+            if (!mFreeEdited.empty())
+            {
+                uint32_t index = mFreeEdited.back();
+                mFreeEdited.pop_back();
+                mEdited[index] = std::move(text);
+                return index + 1;
+            }
+
+            mEdited.push_back(std::move(text));
+            return (uint32_t)mEdited.size();
+        }
+
+        void countLength(size_t length, int32_t change)
+        {
+            auto& count = mLengths[length];
+            count += change;
+            if (count == 0)
+            {
+                mLengths.erase(length);
+            }
+
+            return;
+        }
+
+        ///@param end Allows row to be the row count, for inserting at the end
+        ///@return Chunk and index in it of row
+        [[nodiscard]] std::pair<size_t, size_t> locate(size_t row, bool end) const
+        {
+            if (row > mSize || (row == mSize && !end))
+            {
+                throw std::out_of_range("Row index is out of bounds, row: " + std::to_string(row) + ", size: " + std::to_string(mSize));
+            }
+            if (row == mSize)
+            {
+                return { mChunks.size() - 1, mChunks.back().size() };
+            }
+
+            //Walks down the Fenwick tree to the chunk holding row
+            size_t chunk = 0;
+            for (size_t step = std::bit_floor(mTree.size() - 1); step != 0; step /= 2)
+            {
+                if (chunk + step < mTree.size() && mTree[chunk + step] <= row)
+                {
+                    chunk += step;
+                    row -= mTree[chunk];
+                }
+            }
+
+            return { chunk, row };
+        }
+
+        void treeAdd(size_t chunk, int64_t change)
+        {
+            for (size_t i = chunk + 1; i < mTree.size(); i += i & (~i + 1))
+            {
+                mTree[i] += change;
+            }
+
+            return;
+        }
+        void rebuildTree()
+        {
+            mTree.assign(mChunks.size() + 1, 0);
+            for (size_t i = 1; i < mTree.size(); i++)
+            {
+                mTree[i] += mChunks[i - 1].size();
+                size_t parent = i + (i & (~i + 1));
+                if (parent < mTree.size())
+                {
+                    mTree[parent] += mTree[i];
+                }
+            }
+
+            return;
+        }
+
+        std::string mOriginal; //!<Text given to assign, never changed
+        std::vector<std::string> mEdited; //!<Text of edited rows
+        std::vector<uint32_t> mFreeEdited; //!<Unused indices in mEdited
+        std::vector<std::vector<Row>> mChunks;
+        std::vector<size_t> mTree; //!<Fenwick tree of chunk sizes, 1 based
+        std::map<size_t, size_t> mLengths; //!<Number of rows of each length
+        size_t mSize = 0;
+        size_t mBytes = 0;
+    };
+}
@@ -0,0 +1,309 @@
+///
+///@file conslr/textsearch.hpp
+///@brief Defines TextSearch, an incremental search over lines of text
+///
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Finds needle in haystack starting at from
+    ///
+    ///memchr skips to each occurrence of the first byte and memcmp checks the rest, both are vectorized by the C library
+    ///
+    ///@return Position of the match, std::string_view::npos if none
+    ///
+    inline size_t findText(std::string_view haystack, std::string_view needle, size_t from = 0) noexcept
+    {
+        if (needle.empty() || from > haystack.size() || haystack.size() - from < needle.size())
+        {
+            return std::string_view::npos;
+        }
+
+        const char* it = haystack.data() + from;
+        const char* last = haystack.data() + haystack.size() - needle.size();
+        while (it <= last)
+        {
+            it = (const char*)std::memchr(it, needle[0], last - it + 1);
+            if (it == nullptr)
+            {
+                break;
+            }
+            if (std::memcmp(it + 1, needle.data() + 1, needle.size() - 1) == 0)
+            {
+                return it - haystack.data();
+            }
+            it++;
+        }
+
+        return std::string_view::npos;
+    }
+
+    ///
+    ///Searches lines of text a budget at a time, so large texts can be searched over several frames
+    ///
+    ///Lines are numbered by the owner, lines before the first line may be dropped and lines may be added at the end
+    ///Edited text reports changed, inserted and erased lines, so only those lines are searched again
+    ///The search starts at a chosen line, usually the first visible line, and continues to the end before wrapping to the first line
+    ///Matches found so far can be used while the search continues
+    ///
+    class TextSearch
+    {
+    public:
+        struct Match
+        {
+            uint64_t line;
+            int32_t column;
+
+            auto operator<=>(const Match&) const = default;
+        };
+
+        ///Starts a new search, dropping all matches
+        ///
+        ///@param firstLine First line to search
+        ///@param endLine Line after the last line to search
+        ///@param from Line the search starts at
+        void start(std::string_view query, uint64_t firstLine, uint64_t endLine, uint64_t from)
+        {
+            mQuery = query;
+            mFirst = firstLine;
+            mEnd = endLine;
+            mStart = std::clamp(from, firstLine, endLine);
+            mAfterNext = mStart;
+            mBeforeNext = firstLine;
+            mAfter.clear();
+            mBefore.clear();
+
+            return;
+        }
+
+        ///Stops searching and drops all matches
+        void clear() noexcept
+        {
+            mQuery.clear();
+            mAfter.clear();
+            mBefore.clear();
+
+            return;
+        }
+
+        ///Updates the range of lines, lines before firstLine have been dropped and lines up to endLine have been added
+        void setRange(uint64_t firstLine, uint64_t endLine)
+        {
+            mFirst = std::max(mFirst, firstLine);
+            mEnd = endLine;
+
+            while (!mBefore.empty() && mBefore.front().line < mFirst)
+            {
+                mBefore.pop_front();
+            }
+            while (!mAfter.empty() && mAfter.front().line < mFirst)
+            {
+                mAfter.pop_front();
+            }
+            //mStart stays, the lines from it on have been searched already
+            mAfterNext = std::max(mAfterNext, mFirst);
+            mBeforeNext = std::max(mBeforeNext, mFirst);
+
+            return;
+        }
+
+        ///Searches a changed line again if it has been searched already, lines not searched yet are left to step
+        void lineChanged(uint64_t line, std::string_view text)
+        {
+            if (mQuery.empty() || !isSearched(line))
+            {
+                return;
+            }
+
+            std::deque<Match>& matches = line >= mStart ? mAfter : mBefore;
+            auto first = std::lower_bound(matches.begin(), matches.end(), Match{ line, 0 });
+            auto last = std::lower_bound(first, matches.end(), Match{ line + 1, 0 });
+
+            std::vector<Match> found;
+            searchLine(text, line, found);
+            size_t index = (size_t)(first - matches.begin());
+            matches.erase(first, last);
+            matches.insert(matches.begin() + index, found.begin(), found.end());
+
+            return;
+        }
+        ///Moves the matches of later lines down after count lines were inserted before line
+        ///
+        ///The inserted lines are empty to the search, report their text with lineChanged
+        void linesInserted(uint64_t line, uint64_t count)
+        {
+            if (mQuery.empty())
+            {
+                return;
+            }
+
+            for (auto* matches : { &mBefore, &mAfter })
+            {
+                for (auto it = std::lower_bound(matches->begin(), matches->end(), Match{ line, 0 }); it != matches->end(); it++)
+                {
+                    it->line += count;
+                }
+            }
+
+            //Lines inserted inside a searched range count as searched, so lineChanged searches them
+            auto shift = [&](uint64_t& bound) { if (bound > line) { bound += count; } };
+            shift(mFirst);
+            shift(mBeforeNext);
+            shift(mStart);
+            shift(mAfterNext);
+            mEnd += count;
+
+            return;
+        }
+        ///Drops the matches of count lines from line and moves the matches of later lines up
+        void linesErased(uint64_t line, uint64_t count)
+        {
+            if (mQuery.empty())
+            {
+                return;
+            }
+
+            for (auto* matches : { &mBefore, &mAfter })
+            {
+                auto first = std::lower_bound(matches->begin(), matches->end(), Match{ line, 0 });
+                auto last = std::lower_bound(first, matches->end(), Match{ line + count, 0 });
+                for (auto it = last; it != matches->end(); it++)
+                {
+                    it->line -= count;
+                }
+                matches->erase(first, last);
+            }
+
+            auto shift = [&](uint64_t& bound) { bound = bound >= line + count ? bound - count : std::min(bound, line); };
+            shift(mFirst);
+            shift(mBeforeNext);
+            shift(mStart);
+            shift(mAfterNext);
+            shift(mEnd);
+
+            return;
+        }
+
+        ///Searches lines until about budget bytes have been read
+        ///
+        ///@param getLine Callable taking a line number and returning its text as a std::string_view
+        ///@return true if every line has been searched
+        template <typename GetLine>
+        bool step(GetLine&& getLine, size_t budget)
+        {
+            if (mQuery.empty())
+            {
+                return true;
+            }
+
+            size_t read = 0;
+            while (read < budget && mAfterNext < mEnd)
+            {
+                read += searchLine(getLine(mAfterNext), mAfterNext, mAfter);
+                mAfterNext++;
+            }
+            while (read < budget && mBeforeNext < mStart)
+            {
+                read += searchLine(getLine(mBeforeNext), mBeforeNext, mBefore);
+                mBeforeNext++;
+            }
+
+            return isDone();
+        }
+
+        ///@return Index of the first match after line and column, wrapping to the first match, npos if there are none
+        [[nodiscard]] size_t findAfter(uint64_t line, int32_t column) const noexcept
+        {
+            Match position{ line, column };
+            size_t index = (size_t)(std::upper_bound(mBefore.begin(), mBefore.end(), position) - mBefore.begin());
+            if (index == mBefore.size())
+            {
+                index += (size_t)(std::upper_bound(mAfter.begin(), mAfter.end(), position) - mAfter.begin());
+            }
+
+            if (size() == 0)
+            {
+                return npos;
+            }
+
+            return index == size() ? 0 : index;
+        }
+        ///@return Index of the last match before line and column, wrapping to the last match, npos if there are none
+        [[nodiscard]] size_t findBefore(uint64_t line, int32_t column) const noexcept
+        {
+            Match position{ line, column };
+            size_t index = (size_t)(std::lower_bound(mBefore.begin(), mBefore.end(), position) - mBefore.begin());
+            if (index == mBefore.size())
+            {
+                index += (size_t)(std::lower_bound(mAfter.begin(), mAfter.end(), position) - mAfter.begin());
+            }
+
+            if (size() == 0)
+            {
+                return npos;
+            }
+
+            return index == 0 ? size() - 1 : index - 1;
+        }
+
+        ///Calls fn with every match found in lines first to last, inclusive
+        template <typename Fn>
+        void forEachInLines(uint64_t first, uint64_t last, Fn&& fn) const
+        {
+            for (const auto* matches : { &mBefore, &mAfter })
+            {
+                auto it = std::lower_bound(matches->begin(), matches->end(), Match{ first, 0 });
+                for (; it != matches->end() && it->line <= last; it++)
+                {
+                    fn(*it);
+                }
+            }
+
+            return;
+        }
+
+        ///@return Match at index, in order of line and column
+        [[nodiscard]] const Match& operator[](size_t index) const noexcept { return index < mBefore.size() ? mBefore[index] : mAfter[index - mBefore.size()]; }
+        ///@return Number of matches found so far
+        [[nodiscard]] size_t size() const noexcept { return mBefore.size() + mAfter.size(); }
+        [[nodiscard]] bool isDone() const noexcept { return mQuery.empty() || (mAfterNext >= mEnd && mBeforeNext >= mStart); }
+        [[nodiscard]] const std::string& getQuery() const noexcept { return mQuery; }
+
+        static constexpr size_t npos = SIZE_MAX;
+
+    private:
+        [[nodiscard]] bool isSearched(uint64_t line) const noexcept
+        {
+            return (line >= mStart && line < mAfterNext) || (line >= mFirst && line < mBeforeNext);
+        }
+
+        template <typename Matches>
+        size_t searchLine(std::string_view text, uint64_t line, Matches& matches)
+        {
+            for (size_t column = findText(text, mQuery); column != std::string_view::npos; column = findText(text, mQuery, column + mQuery.size()))
+            {
+                matches.push_back({ line, (int32_t)column });
+            }
+
+            return text.size() + 1;
+        }
+
+        std::string mQuery;
+        uint64_t mFirst = 0;
+        uint64_t mEnd = 0;
+        uint64_t mStart = 0; //!<Line the search started at
+        uint64_t mAfterNext = 0; //!<Next line to search from mStart to the end
+        uint64_t mBeforeNext = 0; //!<Next line to search from the first line to mStart
+        std::deque<Match> mAfter; //!<Matches from mStart on, in order
+        std::deque<Match> mBefore; //!<Matches before mStart, in order
+    };
+}
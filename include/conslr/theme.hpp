@@ -29,6 +29,7 @@ namespace conslr
         SDL_Color text = { 255, 255, 255, 255 }; //!<Text for widgets
         SDL_Color border = { 255, 255, 255, 255 }; //!<Border foreground for widgets
         SDL_Color selection = { 100, 100, 100, 255 }; //!<Selection background color for highlighting
+        SDL_Color highlight = { 120, 100, 0, 255 }; //!<Background color of search matches
                                                       
         ExtendedTheme* extended = nullptr; //!<User implemented theme
     };
@@ -0,0 +1,86 @@
+///
+///@file conslr/trigramindex.hpp
+///@brief Defines TrigramIndex, used to filter lists by name
+///
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace conslr
+{
+    ///
+    ///Maps every three character sequence of a set of names to the names containing it, ignoring ASCII case
+    ///
+    ///A name containing a query contains all of its trigrams, so the shortest list of the query's trigrams
+    ///holds every possible match and only those need to be compared
+    ///
+    class TrigramIndex
+    {
+    public:
+        ///Adds a name, slots must be added in increasing order starting at 0
+        void add(uint32_t slot, std::string_view name)
+        {
+            for (size_t i = 0; i + 3 <= name.size(); i++)
+            {
+                auto& slots = mTrigrams[key(name.substr(i, 3))];
+                //A name repeating a trigram is listed once
+                if (slots.empty() || slots.back() != slot)
+                {
+                    slots.push_back(slot);
+                }
+            }
+
+            mSize = slot + 1;
+
+            return;
+        }
+
+        void clear() noexcept
+        {
+            mTrigrams.clear();
+            mSize = 0;
+
+            return;
+        }
+
+        ///@param query Query of at least three characters
+        ///@return Slots of the names that may contain the query, in increasing order
+        [[nodiscard]] std::span<const uint32_t> getCandidates(std::string_view query) const
+        {
+            std::span<const uint32_t> best;
+            for (size_t i = 0; i + 3 <= query.size(); i++)
+            {
+                auto it = mTrigrams.find(key(query.substr(i, 3)));
+                if (it == mTrigrams.end())
+                {
+                    return {};
+                }
+
+                if (i == 0 || it->second.size() < best.size())
+                {
+                    best = it->second;
+                }
+            }
+
+            return best;
+        }
+
+        ///@return Number of slots added
+        [[nodiscard]] constexpr size_t size() const noexcept { return mSize; }
+
+        [[nodiscard]] static constexpr char toLower(char c) noexcept { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; }
+
+    private:
+        [[nodiscard]] static constexpr uint32_t key(std::string_view trigram) noexcept
+        {
+            return ((uint32_t)(uint8_t)toLower(trigram[0]) << 16) | ((uint32_t)(uint8_t)toLower(trigram[1]) << 8) | (uint32_t)(uint8_t)toLower(trigram[2]);
+        }
+
+        std::unordered_map<uint32_t, std::vector<uint32_t>> mTrigrams;
+        size_t mSize = 0;
+    };
+}
@@ -17,12 +17,22 @@
 #include <stdexcept>
 #include <type_traits>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
+#include <algorithm>
+#include <ranges>
+#include <utility>
+#include <functional>
+#ifdef CONSLR_PARALLEL_SORT
+#include <execution>
+#endif
 
 #include <SDL_rect.h>
 #include <SDL_events.h>
 
+#include "conslr/trigramindex.hpp"
+
 namespace conslr
 {
     class Screen;
@@ -64,21 +74,45 @@ namespace conslr
         friend class conslr::Screen;
         friend class conslr::WidgetManager;
 
-        constexpr void show() noexcept { mVisible = true; mRerender = true; }
-        constexpr void hide() noexcept { mVisible = false; mRerender = true; }
+        constexpr void show() noexcept { mVisible = true; invalidate(); }
+        constexpr void hide() noexcept { mVisible = false; invalidate(); }
         [[nodiscard]] constexpr bool isVisible() const noexcept { return mVisible; }
 
-        constexpr void showTitle() noexcept { mShowTitle = true; mRerender = true; }
-        constexpr void hideTitle() noexcept { mShowTitle = false; mRerender = true; }
+        constexpr void showTitle() noexcept { mShowTitle = true; invalidate(); }
+        constexpr void hideTitle() noexcept { mShowTitle = false; invalidate(); }
+
+        ///Marks the widget to be rerendered on the next frame
+        ///
+        ///The widget is queued on its WidgetManager once until the screen renders, so frames with nothing to redraw cost nothing
+        constexpr void invalidate() noexcept
+        {
+            if (mRerender)
+            {
+                return;
+            }
+
+            mRerender = true;
+            if (mDirtyQueue != nullptr)
+            {
+                mDirtyQueue->push_back(this);
+            }
+        }
 
         //Getters
         [[nodiscard]] constexpr const std::string& getTitle() const noexcept { return mTitle; }
+        [[nodiscard]] constexpr bool needsRerender() const noexcept { return mRerender; }
+        ///Region of the screen the widget renders to
+        ///
+        ///Used by the screen for culling, widgets without a region return an empty rect and are never culled
+        [[nodiscard]] virtual const SDL_Rect& getRegion() const noexcept { return EMPTY_REGION; }
+        ///Opaque widgets overwrite every cell of their region when rendered, hiding anything below them
+        [[nodiscard]] virtual bool isOpaque() const noexcept { return false; }
 
         //Setters
         constexpr void setTitle(const std::string& title) { mTitle = title; }
-        void setTheme(std::shared_ptr<Theme> theme) noexcept { mTheme = theme; }
+        ///The theme is not owned by the widget and must outlive it, the console's theme does
+        constexpr void setTheme(const Theme* theme) noexcept { mTheme = theme; }
 
-        bool mRerender;
     protected:
         constexpr IRenderable() noexcept :
             mRerender{ true }, mVisible{ true },
@@ -88,11 +122,17 @@ namespace conslr
 
         virtual void render(Screen&) {}
 
+        bool mRerender; //!<Set through invalidate, cleared by the screen after rendering
         bool mVisible;
         bool mShowTitle; 
         std::string mTitle; 
 
-        std::shared_ptr<Theme> mTheme;
+        const Theme* mTheme;
+
+        static constexpr SDL_Rect EMPTY_REGION{ 0, 0, 0, 0 };
+
+    private:
+        std::vector<IRenderable*>* mDirtyQueue = nullptr; //!<Set by the WidgetManager that owns the widget
     };
 
     class IScrollable
@@ -102,6 +142,14 @@ namespace conslr
 
         virtual constexpr void scrollUp() noexcept {}
         virtual constexpr void scrollDown() noexcept {}
+        ///Scrolls by several steps at once, negative amounts scroll up
+        ///
+        ///Defaults to repeated scrollUp/scrollDown calls, widgets should override it if they can do better
+        virtual constexpr void scrollBy(int32_t amount) noexcept
+        {
+            for (auto i = 0; i > amount; i--) { scrollUp(); }
+            for (auto i = 0; i < amount; i++) { scrollDown(); }
+        }
 
         [[nodiscard]] constexpr int32_t getSelection() const noexcept { return mSelection; }
 
@@ -119,19 +167,88 @@ namespace conslr
         friend class conslr::WidgetManager;
 
         virtual void doTextInput(SDL_TextInputEvent& event) noexcept { (void)event; }
+        ///Inserts text of any length at once, used when consecutive text input events are coalesced
+        ///
+        ///Text was typed while the widget was active, so it should be inserted even if the widget has lost focus since
+        ///Defaults to splitting the text into text input events, widgets should override it if they can do better
+        virtual void insertText(std::string_view text) noexcept
+        {
+            SDL_TextInputEvent event{};
+            event.type = SDL_TEXTINPUT;
+
+            const size_t chunk = sizeof(event.text) - 1;
+            for (size_t i = 0; i < text.size(); i += chunk)
+            {
+                size_t len = text.copy(event.text, chunk, i);
+                event.text[len] = '\0';
+                doTextInput(event);
+            }
+        }
+
+        //Editing keys, called by the Console when event routing is enabled
+        virtual constexpr void doKeyLeft() noexcept {}
+        virtual constexpr void doKeyRight() noexcept {}
+        virtual constexpr void doKeyUp() noexcept {}
+        virtual constexpr void doKeyDown() noexcept {}
+        virtual constexpr void doTab() {}
+        virtual constexpr void doBackspace() {}
+        virtual constexpr void doReturn() {}
 
     protected:
         constexpr ITextInput() noexcept {}
     };
 
+    ///Mouse events are routed by the Console to the widget under the cursor
+    ///
+    ///Coordinates are in cells relative to the screen
+    class IMouseInput
+    {
+    public:
+        friend class conslr::WidgetManager;
+
+        virtual void doMouseMotion(int32_t x, int32_t y) noexcept { (void)x; (void)y; }
+        virtual void doMouseButton(SDL_MouseButtonEvent& event, int32_t x, int32_t y) noexcept { (void)event; (void)x; (void)y; }
+        ///Widgets that do not override this but are IScrollable are scrolled instead
+        ///
+        ///@return true if the wheel was handled
+        virtual bool doMouseWheel(SDL_MouseWheelEvent& event, int32_t x, int32_t y) noexcept { (void)event; (void)x; (void)y; return false; }
+
+    protected:
+        constexpr IMouseInput() noexcept {}
+    };
+
+    ///Widgets updated once per frame by Console::render, before any screen is rendered
+    ///
+    ///For picking up changes made outside the event loop, such as text queued by other threads
+    class IUpdatable
+    {
+    public:
+        friend class conslr::WidgetManager;
+
+        virtual void update() {}
+
+    protected:
+        constexpr IUpdatable() noexcept {}
+    };
+
     template <typename T>
     struct ListContainer
     {
-        size_t mIndex;
+        size_t mIndex; //!<Stable id of the element, unchanged when other elements are removed
         T mElement;
         std::string mName;
     };
 
+    ///
+    ///Elements of a list widget
+    ///
+    ///Positions are indices into a view of the elements, removed elements are left as tombstones in the storage
+    ///and only the view is shifted, so removing does not move or renumber the elements themselves
+    ///The storage is compacted once more than half of it is tombstones
+    ///
+    ///While a filter is set, positions refer to the matching elements only, and removed elements are only dropped
+    ///from the full list order once it is needed again
+    ///
     template <typename T>
     class IList
     {
@@ -140,41 +257,403 @@ namespace conslr
 
         virtual void addElement(const T& element, const std::string& name)
         {
-            mElements.emplace_back(mElements.size(), element, name);
+            pushElement(element, name);
 
             return;
         }
 
+        ///Removes the element at a position
+        ///
+        ///Linear in the number of shown elements, as the positions after it shift down by one,
+        ///use removeElements to remove many elements in one linear pass
         virtual void removeElement(size_t index)
         {
-            if (index >= mElements.size())
+            if (index >= view().size())
             {
-                throw std::runtime_error(std::string("Index is out of bounds, index: ") + std::to_string(index) + ", size: " + std::to_string(mElements.size()));
+                throw std::runtime_error(std::string("Index is out of bounds, index: ") + std::to_string(index) + ", size: " + std::to_string(view().size()));
             }
 
-            mElements.erase(mElements.begin() + index);
+            uint32_t slot = view()[index];
+            mRemoved[slot] = true;
+            mRemovedCount++;
+            if (mFiltering)
+            {
+                //The tombstone stays in mOrder until purgeOrder
+                mFiltered.erase(mFiltered.begin() + index);
+                mOrderStale = true;
+            }
+            else
+            {
+                mOrder.erase(mOrder.begin() + index);
+            }
+            compactIfSparse();
+
+            return;
+        }
+
+        ///Shows only the elements whose name contains the query, ignoring ASCII case
+        ///
+        ///A query extending the previous one only searches the previous matches,
+        ///other queries of three or more characters are looked up in a trigram index of the names
+        ///Renaming an element does not reapply the filter
+        ///
+        ///@param query Text to search for, empty to show all elements
+        virtual void setFilter(std::string_view query)
+        {
+            purgeOrder();
+
+            std::string filter(query.size(), '\0');
+            std::ranges::transform(query, filter.begin(), TrigramIndex::toLower);
 
-            for (size_t i = index; i < mElements.size(); i++)
+            if (filter.empty())
             {
-                mElements.at(i).mIndex = i;
+                mFiltering = false;
+                mFiltered.clear();
+            }
+            else if (mFiltering && filter.find(mFilter) != std::string::npos)
+            {
+                //Anything matching the new filter matched the old one
+                std::erase_if(mFiltered, [&](uint32_t slot) { return !matches(mElements[slot].mName, filter); });
+            }
+            else
+            {
+                mFiltered.clear();
+                if (filter.size() >= 3)
+                {
+                    for (auto i = mNameIndex.size(); i < mElements.size(); i++)
+                    {
+                        mNameIndex.add((uint32_t)i, mElements[i].mName);
+                    }
+
+                    //Candidates are in storage order, walk the list to keep list order
+                    std::vector<uint8_t> candidate(mElements.size(), 0);
+                    for (auto slot : mNameIndex.getCandidates(filter))
+                    {
+                        candidate[slot] = 1;
+                    }
+                    for (auto slot : mOrder)
+                    {
+                        if (candidate[slot] && matches(mElements[slot].mName, filter))
+                        {
+                            mFiltered.push_back(slot);
+                        }
+                    }
+                }
+                else
+                {
+                    for (auto slot : mOrder)
+                    {
+                        if (matches(mElements[slot].mName, filter))
+                        {
+                            mFiltered.push_back(slot);
+                        }
+                    }
+                }
+
+                mFiltering = true;
+            }
+
+            mFilter = std::move(filter);
+
+            return;
+        }
+
+        ///Appends a range of std::pair<T, std::string>, moving out of it if it is an rvalue
+        template <std::ranges::input_range R>
+        void addElements(R&& elements)
+        {
+            if constexpr (std::ranges::sized_range<R>)
+            {
+                mElements.reserve(mElements.size() + std::ranges::size(elements));
+                mOrder.reserve(mOrder.size() + std::ranges::size(elements));
+            }
+
+            for (auto&& element : elements)
+            {
+                if constexpr (std::is_rvalue_reference_v<R&&>)
+                {
+                    pushElement(std::move(element.first), std::move(element.second));
+                }
+                else
+                {
+                    pushElement(element.first, element.second);
+                }
+            }
+
+            elementsChanged();
+
+            return;
+        }
+
+        ///Removes every element the predicate returns true for
+        ///
+        ///@param pred Called with each const ListContainer<T>&
+        ///@return Number of removed elements
+        template <typename Pred>
+        size_t removeElements(Pred pred)
+        {
+            purgeOrder();
+
+            auto removed = std::ranges::remove_if(mOrder, [&](uint32_t slot)
+                {
+                    if (pred(std::as_const(mElements[slot])))
+                    {
+                        mRemoved[slot] = true;
+                        return true;
+                    }
+
+                    return false;
+                });
+            size_t count = removed.size();
+            mOrder.erase(removed.begin(), removed.end());
+            mRemovedCount += count;
+            if (mFiltering && count != 0)
+            {
+                std::erase_if(mFiltered, [&](uint32_t slot) { return mRemoved[slot]; });
+            }
+            compactIfSparse();
+
+            if (count != 0)
+            {
+                elementsChanged();
+            }
+
+            return count;
+        }
+
+        ///Replaces all elements with a range of std::pair<T, std::string>, ids continue from the previous elements
+        template <std::ranges::input_range R>
+        void assign(R&& elements)
+        {
+            mElements.clear();
+            mOrder.clear();
+            mFiltered.clear();
+            mRemoved.clear();
+            mRemovedCount = 0;
+            mOrderStale = false;
+            mNameIndex.clear();
+            slotsMoved({});
+
+            addElements(std::forward<R>(elements));
+
+            return;
+        }
+
+        ///Sorts the elements by a key, equal keys keep their order
+        ///
+        ///Only the list order is sorted, the elements are not moved. The key is computed once per element
+        ///Lists of PARALLEL_SORT_THRESHOLD or more elements are sorted in parallel if built with CONSLR_PARALLEL_SORT
+        ///
+        ///@param keyFn Called with each const ListContainer<T>&, returns a value comparable with <
+        template <typename KeyFn>
+        void sortBy(KeyFn keyFn)
+        {
+            using Key = std::decay_t<std::invoke_result_t<KeyFn&, const ListContainer<T>&>>;
+
+            purgeOrder();
+
+            std::vector<std::pair<Key, uint32_t>> keyed;
+            keyed.reserve(mOrder.size());
+            for (auto slot : mOrder)
+            {
+                keyed.emplace_back(std::invoke(keyFn, std::as_const(mElements[slot])), slot);
+            }
+
+            auto byKey = [](const std::pair<Key, uint32_t>& a, const std::pair<Key, uint32_t>& b) { return a.first < b.first; };
+#if defined(CONSLR_PARALLEL_SORT) && defined(__cpp_lib_parallel_algorithm)
+            if (keyed.size() >= PARALLEL_SORT_THRESHOLD)
+            {
+                std::stable_sort(std::execution::par, keyed.begin(), keyed.end(), byKey);
+            }
+            else
+#endif
+            {
+                std::stable_sort(keyed.begin(), keyed.end(), byKey);
+            }
+
+            for (size_t i = 0; i < keyed.size(); i++)
+            {
+                mOrder[i] = keyed[i].second;
+            }
+
+            if (mFiltering)
+            {
+                //The matches keep the new list order
+                std::vector<uint8_t> matched(mElements.size(), 0);
+                for (auto slot : mFiltered)
+                {
+                    matched[slot] = 1;
+                }
+                mFiltered.clear();
+                for (auto slot : mOrder)
+                {
+                    if (matched[slot])
+                    {
+                        mFiltered.push_back(slot);
+                    }
+                }
             }
 
             return;
         }
 
         //Getters
-        const ListContainer<T>& getElement(size_t index) { return mElements.at(index); }
-        constexpr const std::vector<ListContainer<T>>& getElements() noexcept { return mElements; }
-        constexpr size_t size() const noexcept { return mElements.size(); }
-        
+        const ListContainer<T>& getElement(size_t index) const { return mElements[view().at(index)]; }
+        ///Finds an element by its stable id, whether or not it matches the filter
+        ///
+        ///@return The element, nullptr if it was removed or never existed
+        const ListContainer<T>* findElement(size_t id) const
+        {
+            //Ids increase with the storage order, compacting keeps the order
+            auto it = std::ranges::lower_bound(mElements, id, {}, &ListContainer<T>::mIndex);
+            if (it == mElements.end() || it->mIndex != id || mRemoved[it - mElements.begin()])
+            {
+                return nullptr;
+            }
+
+            return &*it;
+        }
+        ///Elements in list order
+        auto getElements() const noexcept
+        {
+            return view() | std::views::transform([this](uint32_t slot) -> const ListContainer<T>& { return mElements[slot]; });
+        }
+        constexpr size_t size() const noexcept { return view().size(); }
+        ///@return Current filter in lower case, empty if none is set
+        constexpr const std::string& getFilter() const noexcept { return mFilter; }
+
         //Setters
-        void setElementName(size_t index, const std::string& name) { mElements.at(index).mName = name; }
-        void setElement(size_t index, const T& element) { mElements.at(index).mElement = element; }
+        void setElementName(size_t index, const std::string& name)
+        {
+            mElements[view().at(index)].mName = name;
+            mNameIndex.clear();
+
+            return;
+        }
+        void setElement(size_t index, const T& element) { mElements[view().at(index)].mElement = element; }
+
+        static constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 16;
 
     protected:
         constexpr IList() noexcept {}
 
-        std::vector<ListContainer<T>> mElements;
+        ///Called once after addElements, removeElements and assign, widgets should invalidate here
+        virtual void elementsChanged() {}
+        ///Called when compacting moves elements to other storage slots, widgets keeping data by slot should move it here
+        ///
+        ///@param newSlots New slot of each old slot, REMOVED_SLOT for removed elements, empty if assign removed every element
+        virtual void slotsMoved(const std::vector<uint32_t>& newSlots) { (void)newSlots; }
+
+        static constexpr uint32_t REMOVED_SLOT = UINT32_MAX;
+
+        ListContainer<T>& elementAt(size_t index) { return mElements[view().at(index)]; }
+        ///@return Position of a storage slot in the shown elements, size() if it is not shown
+        size_t findSlot(uint32_t slot) const { return std::ranges::find(view(), slot) - view().begin(); }
+        ///Storage slots of the shown elements in list order
+        constexpr const std::vector<uint32_t>& view() const noexcept { return mFiltering ? mFiltered : mOrder; }
+        [[nodiscard]] bool isRemoved(uint32_t slot) const { return mRemoved[slot]; }
+
+        std::vector<ListContainer<T>> mElements; //!<Storage, including removed elements
+        std::vector<uint32_t> mOrder; //!<Storage slots of the elements in list order
+        std::vector<uint32_t> mFiltered; //!<Storage slots of the elements matching mFilter in list order
+
+    private:
+        static bool matches(std::string_view name, std::string_view filter)
+        {
+            return !std::ranges::search(name, filter, {}, TrigramIndex::toLower).empty();
+        }
+
+        template <typename E, typename N>
+        void pushElement(E&& element, N&& name)
+        {
+            uint32_t slot = (uint32_t)mElements.size();
+            mOrder.push_back(slot);
+            mElements.push_back({ mNextId++, std::forward<E>(element), std::forward<N>(name) });
+            mRemoved.push_back(false);
+            if (mFiltering && matches(mElements.back().mName, mFilter))
+            {
+                mFiltered.push_back(slot);
+            }
+
+            return;
+        }
+
+        void compactIfSparse()
+        {
+            if (mRemovedCount <= mElements.size() / 2)
+            {
+                return;
+            }
+            purgeOrder();
+
+            std::vector<uint32_t> newSlots(mElements.size(), REMOVED_SLOT);
+            size_t kept = 0;
+            for (size_t i = 0; i < mElements.size(); i++)
+            {
+                if (!mRemoved[i])
+                {
+                    newSlots[i] = (uint32_t)kept;
+                    if (kept != i)
+                    {
+                        mElements[kept] = std::move(mElements[i]);
+                    }
+                    kept++;
+                }
+            }
+
+            mElements.erase(mElements.begin() + kept, mElements.end());
+            mRemoved.assign(kept, false);
+            mRemovedCount = 0;
+            for (auto& slot : mOrder)
+            {
+                slot = newSlots[slot];
+            }
+            for (auto& slot : mFiltered)
+            {
+                slot = newSlots[slot];
+            }
+            //Slots changed, the index is rebuilt by the next filter
+            mNameIndex.clear();
+            slotsMoved(newSlots);
+
+            return;
+        }
+
+        ///Drops removed elements from mOrder, which keeps them while a filter is set
+        void purgeOrder()
+        {
+            if (mOrderStale)
+            {
+                std::erase_if(mOrder, [this](uint32_t slot) { return mRemoved[slot]; });
+                mOrderStale = false;
+            }
+
+            return;
+        }
+
+        std::vector<bool> mRemoved; //!<Tombstones, indexed like mElements
+        size_t mRemovedCount = 0;
+        bool mOrderStale = false; //!<True if mOrder may hold removed elements, only while filtering
+        size_t mNextId = 0;
+
+        std::string mFilter;
+        bool mFiltering = false;
+        TrigramIndex mNameIndex; //!<Trigrams of the names, extended by the next filter when elements are added
+    };
+
+    ///Supplies the rows of a virtual list on demand, see ScrollList::setProvider
+    ///
+    ///Only the visible rows are requested, so the data can be generated or paged in lazily
+    template <typename T>
+    class IListProvider
+    {
+    public:
+        virtual ~IListProvider() = default;
+
+        [[nodiscard]] virtual size_t size() const = 0;
+        ///@return Name of the row, must stay valid until the next call to the provider
+        [[nodiscard]] virtual std::string_view getName(size_t index) = 0;
+        [[nodiscard]] virtual T getElement(size_t index) = 0;
     };
 
     template <class T>
@@ -6,17 +6,20 @@
 ///1) Create a screen for a console
 ///2) Get widget manager from screen
 ///3) Add widgets to screen with createWidget<T>(), where type T inherits from IWidget but is not an interface
+///
+///Widget ids hold a slot index and a generation, destroying a widget bumps the generation of its slot
+///so old ids of destroyed widgets are detected instead of referring to whichever widget reuses the slot
 #pragma once
 
 #include <cstdint>
 #include <memory>
-#include <queue>
-#include <array>
-#include <list>
+#include <vector>
 #include <type_traits>
 #include <string>
 #include <unordered_map>
 #include <stdexcept>
+#include <typeinfo>
+#include <utility>
 
 #include "conslr/widget.hpp"
 
@@ -24,12 +27,61 @@ namespace conslr
 {
     struct Theme;
     class Screen;
+    class WidgetManager;
+
+    ///Typed id of a widget, resolved to a reference through the WidgetManager that created it
+    ///
+    ///Unlike a weak_ptr, resolving a handle does not touch a reference count
+    ///Handles of destroyed widgets are stale and throw when resolved, as do handles resolved through another WidgetManager
+    ///whose widget at that id is of another type
+    ///Only WidgetManager makes handles, use createWidgetHandle or getHandle
+    template<IsWidget T>
+    class WidgetHandle
+    {
+    public:
+        friend class WidgetManager;
+
+        constexpr WidgetHandle() noexcept = default;
+
+        [[nodiscard]] constexpr bool operator==(const WidgetHandle&) const noexcept = default;
+
+        //Getters
+        [[nodiscard]] constexpr int32_t getId() const noexcept { return mId; }
+        ///@return True if the handle was default constructed and refers to no widget
+        [[nodiscard]] constexpr bool isNull() const noexcept { return mId < 0; }
+
+    private:
+        explicit constexpr WidgetHandle(int32_t id) noexcept : mId{ id } {}
+
+        int32_t mId = -1;
+    };
 
     class WidgetManager
     {
     public:
         friend class Screen;
 
+        ///Interfaces implemented by a widget, resolved once when the widget is created
+        ///
+        ///Interfaces the widget does not implement are nullptr
+        struct WidgetInterfaces
+        {
+            IWidget* widget = nullptr;
+            IRenderable* renderable = nullptr;
+            IScrollable* scrollable = nullptr;
+            ITextInput* textInput = nullptr;
+            IMouseInput* mouseInput = nullptr;
+            IUpdatable* updatable = nullptr;
+        };
+
+        ///Entry in the render order, priority and id are cached so sorting and lookups need no casts
+        struct RenderEntry
+        {
+            IRenderable* renderable;
+            int32_t priority;
+            int32_t id;
+        };
+
         WidgetManager(const WidgetManager&) = delete;
         WidgetManager(WidgetManager&&) = delete;
         WidgetManager& operator=(const WidgetManager&) = delete;
@@ -40,37 +92,45 @@ namespace conslr
         ///@tparam T Type of widget to create, type must inherit from IWidget and must not be a widget interface
         ///@param priority Priority of the created widget
         ///@return Returns a weak pointer to the created widget
+        ///
+        ///Locking the weak pointer is an atomic reference count round trip, prefer createWidgetHandle()
+        ///unless the widget has to be kept alive from another thread
         template<IsWidget T>
             requires (!std::same_as<T, IWidget>)
         [[nodiscard]] std::weak_ptr<T> createWidget(int32_t priority = 0)
         {
-            if (mFreeWidgets.empty())
-            {
-                throw std::runtime_error("WidgetManager has reached the max number of widgets, max: " + std::to_string(MAX_WIDGETS));
-            }
-
-            int32_t index = mFreeWidgets.front();
-            mFreeWidgets.pop();
-
-            std::shared_ptr<T> ptr{ new T(index, priority) };
-            mWidgets.at(index) = ptr;
-
-            if (std::is_base_of<IRenderable, T>())
-            {
-                ptr->setTheme(mTheme);
-                mRenderable.push_back(ptr);
-                mRenderable.sort([](const std::shared_ptr<IRenderable>& a, const std::shared_ptr<IRenderable>& b) -> bool
-                        {
-                            return std::dynamic_pointer_cast<IWidget>(a)->getPriority() < std::dynamic_pointer_cast<IWidget>(b)->getPriority();
-                        });
-            }
-
-            return ptr;
+            return makeWidget<T>(priority);
         }
-        void destroyWidget(int32_t index);
+        ///Creates a widget
+        ///
+        ///@tparam T Type of widget to create, type must inherit from IWidget and must not be a widget interface
+        ///@param priority Priority of the created widget
+        ///@return Returns a handle to the created widget, use get() to access it
+        template<IsWidget T>
+            requires (!std::same_as<T, IWidget>)
+        [[nodiscard]] WidgetHandle<T> createWidgetHandle(int32_t priority = 0)
+        {
+            return WidgetHandle<T>{ makeWidget<T>(priority)->getId() };
+        }
+        ///Destroys a widget, its id becomes stale and is never given to another widget
+        void destroyWidget(int32_t id);
 
-        void activateWidget(int32_t index);
-        void deactivateWidget(int32_t index);
+        ///Activates a widget and gives it focus
+        ///
+        ///Only rerenders the widget if it was not already active
+        void activateWidget(int32_t id);
+        ///Deactivates a widget, removing its focus if it has it
+        ///
+        ///Only rerenders the widget if it was active
+        void deactivateWidget(int32_t id);
+        ///Changes the priority of a widget, moving it in the render order
+        void setPriority(int32_t id, int32_t priority);
+        ///Moves focus to the next visible widget in render order that takes input (IScrollable or ITextInput)
+        ///
+        ///The focused widget is deactivated and the next one activated, wrapping around to the first
+        void focusNext();
+        ///Calls IUpdatable::update on every updatable widget, called by Console::render each frame
+        void updateWidgets();
 
         ///Creates widgets from a file
         ///Clears existing widgets to do so
@@ -83,43 +143,206 @@ namespace conslr
 
         //Getters
         template<IsWidget T>
-        [[nodiscard]] constexpr std::weak_ptr<T> getWidget(int index)
+        [[nodiscard]] std::weak_ptr<T> getWidget(int32_t id)
         {
-            if (!(index >= 0 && index < MAX_WIDGETS))
+            return std::dynamic_pointer_cast<T>(getSlot(id).widget);
+        }
+        ///Gets the interfaces of a widget without locking or casting
+        ///
+        ///@return Interfaces of the widget, all nullptr if the id is stale or was never created
+        [[nodiscard]] const WidgetInterfaces& getInterfaces(int32_t id) const noexcept
+        {
+            static const WidgetInterfaces noInterfaces{};
+
+            const Slot* slot = findSlot(id);
+            return slot ? slot->interfaces : noInterfaces;
+        }
+        ///Gets a handle to a widget, checking the type of the widget once
+        ///
+        ///@tparam T Type of the widget, must be the type it was created as or one of its bases
+        template<IsWidget T>
+        [[nodiscard]] WidgetHandle<T> getHandle(int32_t id) const
+        {
+            if (dynamic_cast<T*>(getSlot(id).widget.get()) == nullptr)
             {
-                throw std::invalid_argument("Index is out of bounds, index: " + std::to_string(index));
+                throw std::invalid_argument("Widget is not of the requested type, id: " + std::to_string(id));
             }
-            if (mWidgets.at(index) == nullptr)
+
+            return WidgetHandle<T>{ id };
+        }
+        ///Resolves a handle to its widget
+        ///
+        ///Handles of the created type are resolved without a cast check, handles of a base type check with dynamic_cast
+        template<IsWidget T>
+        [[nodiscard]] T& get(WidgetHandle<T> handle)
+        {
+            return const_cast<T&>(std::as_const(*this).get(handle));
+        }
+        template<IsWidget T>
+        [[nodiscard]] const T& get(WidgetHandle<T> handle) const
+        {
+            const Slot& slot = getSlot(handle.getId());
+            if (slot.type != &typeid(T) && dynamic_cast<const T*>(slot.widget.get()) == nullptr)
             {
-                throw std::runtime_error("Widget at index is nullptr, index: " + std::to_string(index));
+                throw std::invalid_argument("Widget is not of the handle's type, id: " + std::to_string(handle.getId()));
             }
 
-            return std::dynamic_pointer_cast<T>(mWidgets.at(index));
+            return static_cast<const T&>(*slot.widget);
         }
-        [[nodiscard]] constexpr const std::list<std::shared_ptr<IRenderable>>& getRenderable() const noexcept { return mRenderable; }
-        [[nodiscard]] std::weak_ptr<Theme> getTheme() const noexcept { return mTheme; }
+        ///@return True if the id refers to a widget that has not been destroyed
+        [[nodiscard]] bool isAlive(int32_t id) const noexcept { return findSlot(id) != nullptr; }
+        ///Gets all live widgets, packed contiguously in no particular order
+        [[nodiscard]] constexpr const std::vector<IWidget*>& getWidgets() const noexcept { return mDense; }
+        ///Gets renderable widgets in render order, lowest priority first
+        [[nodiscard]] constexpr const std::vector<RenderEntry>& getRenderable() const noexcept { return mRenderable; }
+        [[nodiscard]] constexpr const Theme* getTheme() const noexcept { return mTheme; }
+        ///@return True if any widget has been invalidated since the screen last rendered
+        [[nodiscard]] constexpr bool isDirty() const noexcept { return !mDirty.empty(); }
+        ///@return Id of the widget that has focus, or -1 if none
+        [[nodiscard]] constexpr int32_t getFocused() const noexcept { return mFocused; }
+        ///@return Id of the widget that had focus before the current one, or -1 if none or it was destroyed
+        [[nodiscard]] constexpr int32_t getPreviousFocused() const noexcept { return mPreviousFocused; }
 
         //Setters
-        void setTheme(std::shared_ptr<Theme> theme) noexcept 
+        constexpr void setTheme(const Theme* theme) noexcept
         {
-            mTheme = theme; 
-            
-            for (auto& widget : mRenderable)
+            mTheme = theme;
+
+            for (auto& entry : mRenderable)
             {
-                widget->setTheme(mTheme);                
+                entry.renderable->setTheme(mTheme);
             }
         }
 
-        static const int32_t MAX_WIDGETS = 16;
+        static const int32_t INDEX_BITS = 20; //!<Low bits of a widget id hold the slot index, the rest hold the slot generation
+        static const int32_t INDEX_MASK = (1 << INDEX_BITS) - 1;
+        static const int32_t MAX_GENERATION = (1 << (31 - INDEX_BITS)) - 1;
 
     private:
+        ///Storage for one widget, reused with a new generation after the widget is destroyed
+        struct Slot
+        {
+            std::shared_ptr<IWidget> widget = nullptr;
+            WidgetInterfaces interfaces{};
+            const std::type_info* type = nullptr; //!<Type the widget was created as
+            int32_t generation = 0;
+            int32_t dense = -1; //!<Position of the widget in mDense
+            int32_t nextFree = -1; //!<Next slot in the free list
+        };
+
         WidgetManager();
 
-        std::queue<int32_t> mFreeWidgets;
-        std::array<std::shared_ptr<IWidget>, MAX_WIDGETS> mWidgets;
+        [[nodiscard]] const Slot* findSlot(int32_t id) const noexcept
+        {
+            if (id < 0)
+            {
+                return nullptr;
+            }
+
+            size_t index = static_cast<size_t>(id & INDEX_MASK);
+            if (index >= mSlots.size())
+            {
+                return nullptr;
+            }
+
+            const Slot& slot = mSlots[index];
+            if (slot.widget == nullptr || slot.generation != (id >> INDEX_BITS))
+            {
+                return nullptr;
+            }
+
+            return &slot;
+        }
+        [[nodiscard]] const Slot& getSlot(int32_t id) const
+        {
+            if (id < 0 || static_cast<size_t>(id & INDEX_MASK) >= mSlots.size())
+            {
+                throw std::invalid_argument("Widget id is out of bounds, id: " + std::to_string(id));
+            }
+
+            const Slot* slot = findSlot(id);
+            if (slot == nullptr)
+            {
+                throw std::runtime_error("Widget id is stale, widget was destroyed, id: " + std::to_string(id));
+            }
+
+            return *slot;
+        }
+
+        template<IsWidget T>
+        [[nodiscard]] std::shared_ptr<T> makeWidget(int32_t priority)
+        {
+            if (mFreeHead < 0 && mSlots.size() > static_cast<size_t>(INDEX_MASK))
+            {
+                throw std::runtime_error("WidgetManager has reached the max number of widgets, max: " + std::to_string(INDEX_MASK + 1));
+            }
+
+            int32_t index = mFreeHead >= 0 ? mFreeHead : static_cast<int32_t>(mSlots.size());
+            int32_t generation = mFreeHead >= 0 ? mSlots[index].generation : 0;
+
+            std::shared_ptr<T> ptr{ new T((generation << INDEX_BITS) | index, priority) };
+
+            if (index == mFreeHead)
+            {
+                mFreeHead = mSlots[index].nextFree;
+            }
+            else
+            {
+                mSlots.emplace_back();
+            }
+
+            auto& slot = mSlots[index];
+            slot.widget = ptr;
+            slot.type = &typeid(T);
+            slot.dense = static_cast<int32_t>(mDense.size());
+            slot.nextFree = -1;
+            mDense.push_back(ptr.get());
+
+            auto& interfaces = slot.interfaces;
+            interfaces = {};
+            interfaces.widget = ptr.get();
+            if constexpr (std::is_base_of_v<IRenderable, T>) { interfaces.renderable = ptr.get(); }
+            if constexpr (std::is_base_of_v<IScrollable, T>) { interfaces.scrollable = ptr.get(); }
+            if constexpr (std::is_base_of_v<ITextInput, T>) { interfaces.textInput = ptr.get(); }
+            if constexpr (std::is_base_of_v<IMouseInput, T>) { interfaces.mouseInput = ptr.get(); }
+            if constexpr (std::is_base_of_v<IUpdatable, T>)
+            {
+                interfaces.updatable = ptr.get();
+                mUpdatable.push_back(ptr.get());
+            }
+
+            if constexpr (std::is_base_of_v<IRenderable, T>)
+            {
+                ptr->setTheme(mTheme);
+                insertRenderable({ ptr.get(), priority, ptr->getId() });
+
+                //New widgets start out needing a render
+                ptr->mDirtyQueue = &mDirty;
+                if (ptr->mRerender)
+                {
+                    mDirty.push_back(ptr.get());
+                }
+            }
+
+            return ptr;
+        }
+
+        std::vector<Slot> mSlots;
+        std::vector<IWidget*> mDense; //!<Live widgets, packed for iteration
+        int32_t mFreeHead = -1; //!<First slot in the free list, -1 if empty
+
+        ///Inserts after entries of equal priority, so widgets of the same priority render in creation order
+        void insertRenderable(const RenderEntry& entry);
+        ///@return Position of the widget in the render order, or end if it is not renderable
+        [[nodiscard]] std::vector<RenderEntry>::iterator findRenderable(int32_t id, int32_t priority) noexcept;
+
+        std::vector<RenderEntry> mRenderable; //!<Sorted by priority
+        std::vector<IRenderable*> mDirty; //!<Widgets invalidated since the last render, each at most once
+        std::vector<IUpdatable*> mUpdatable;
 
-        std::list<std::shared_ptr<IRenderable>> mRenderable;
+        const Theme* mTheme = nullptr;
 
-        std::shared_ptr<Theme> mTheme = nullptr;
+        int32_t mFocused = -1; //!<Most recently activated widget, receives routed events
+        int32_t mPreviousFocused = -1;
     };
 }
@@ -5,12 +5,16 @@
 #pragma once
 
 #include <cassert>
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include <SDL.h>
 
 #include "conslr/widget.hpp"
+#include "conslr/bitset.hpp"
 #include "conslr/screen.hpp"
 #include "conslr/theme.hpp"
 #include "conslr/widgetmanager.hpp"
@@ -18,28 +22,49 @@
 
 namespace conslr::widgets
 {
+    ///Allows the user to check any number of items of a list
+    ///
+    ///Check states are kept in a bitset indexed by storage slot, so counting and checking or unchecking every element work a word at a time
+    ///The bits are moved when the list compacts its storage, so they stay proportional to the number of elements
+    ///Shift clicking checks or unchecks the rows between the last clicked row and the clicked row
+    ///
+    ///@tparam Type of the elements of the CheckList
     template<typename T>
-    using CheckListContainer = std::pair<T, bool>;
-
-    template<typename T>
-    class CheckList : public IWidget, public IRenderable, public IScrollable, public IList<CheckListContainer<T>>
+    class CheckList : public IWidget, public IRenderable, public IScrollable, public IMouseInput, public IList<T>
     {
     public:
         friend class conslr::Screen;
         friend class conslr::WidgetManager;
 
-        virtual void addElement(const CheckListContainer<T>& t, const std::string& name) override
+        virtual void addElement(const T& t, const std::string& name) override
         {
-            IList<CheckListContainer<T>>::addElement(t, name);
-            mRerender = true;
+            IList<T>::addElement(t, name);
+            size_t slot = IList<T>::mElements.size() - 1;
+            mChecked.resize(slot + 1);
+            mAlive.resize(slot + 1);
+            mAlive.set(slot, true);
+            invalidate();
+
+            return;
+        }
+
+        void addElement(const T& t, const std::string& name, bool checked)
+        {
+            addElement(t, name);
+            mChecked.set(IList<T>::mElements.size() - 1, checked);
 
             return;
         }
 
         virtual void removeElement(size_t index) override
         {
-            IList<CheckListContainer<T>>::removeElement(index);
-            if ((size_t)mSelection == IList<CheckListContainer<T>>::size())
+            //Cleared first, removing may compact the storage and move the slots
+            uint32_t slot = slotAt(index);
+            mChecked.set(slot, false);
+            mAlive.set(slot, false);
+            IList<T>::removeElement(index);
+            mAnchor = -1;
+            if ((size_t)mSelection == IList<T>::size())
             {
                 //If the removed element was the last, and it was selected, scroll up
                 scrollUp();
@@ -49,14 +74,51 @@ namespace conslr::widgets
             {
                 mScrollY--;
             }
-            mRerender = true;
+            invalidate();
+
+            return;
+        }
+
+        virtual void setFilter(std::string_view query) override
+        {
+            IList<T>::setFilter(query);
+            //The first match is selected
+            mSelection = 0;
+            mScrollY = 0;
+            mAnchor = -1;
+            invalidate();
+
+            return;
+        }
+
+        ///Sorts the list with IList::sortBy, the selected element stays selected at the same row
+        template <typename KeyFn>
+        void sortBy(KeyFn keyFn)
+        {
+            int32_t count = (int32_t)IList<T>::size();
+            if (count == 0)
+            {
+                //Elements hidden by a filter are still sorted
+                IList<T>::sortBy(std::move(keyFn));
+                return;
+            }
+
+            uint32_t selected = IList<T>::view()[mSelection];
+            int32_t row = mSelection - mScrollY;
+
+            IList<T>::sortBy(std::move(keyFn));
+
+            mSelection = (int32_t)IList<T>::findSlot(selected);
+            mScrollY = std::clamp(mSelection - row, 0, std::max(0, count - (mRegion.h - 2)));
+            mAnchor = -1;
+            invalidate();
 
             return;
         }
 
         virtual constexpr void scrollUp() noexcept override
         {
-            if (IList<CheckListContainer<T>>::size() == 0)
+            if (IList<T>::size() == 0)
             {
                 return;
             }
@@ -67,18 +129,18 @@ namespace conslr::widgets
                 mScrollY--;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
         virtual constexpr void scrollDown() noexcept override
         {
-            if (IList<CheckListContainer<T>>::size() == 0)
+            if (IList<T>::size() == 0)
             {
                 return;
             }
 
-            mSelection = std::min((int32_t)IList<CheckListContainer<T>>::size() - 1, mSelection + 1);
+            mSelection = std::min((int32_t)IList<T>::size() - 1, mSelection + 1);
             //Subtracted by 1 to get the last element
             //without it it would be past the last element
             if (mSelection > mScrollY + mRegion.h - 2 - 1)
@@ -86,27 +148,129 @@ namespace conslr::widgets
                 mScrollY++;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
 
         bool toggleCurrentElement() 
         {
-            auto& element = IList<CheckListContainer<T>>::mElements.at(mSelection);
-            element.mElement.second = !element.mElement.second;
+            if (IList<T>::size() == 0)
+            {
+                return false;
+            }
+
+            bool checked = !isChecked(mSelection);
+            setChecked(mSelection, checked);
+
+            return checked;
+        }
+
+        void setChecked(size_t index, bool checked)
+        {
+            mChecked.set(slotAt(index), checked);
+            invalidate();
+
+            return;
+        }
+
+        ///Checks or unchecks the shown elements from first to last, inclusive and in either order
+        void setCheckedRange(size_t first, size_t last, bool checked)
+        {
+            if (first > last)
+            {
+                std::swap(first, last);
+            }
+
+            for (auto i = first; i <= last; i++)
+            {
+                mChecked.set(slotAt(i), checked);
+            }
+            invalidate();
+
+            return;
+        }
+
+        ///Checks every element, including those hidden by a filter
+        void checkAll() { mChecked = mAlive; invalidate(); }
+        ///Unchecks every element, including those hidden by a filter
+        void uncheckAll() { mChecked.setAll(false); invalidate(); }
+        ///Inverts every element, including those hidden by a filter
+        void invertChecked() { mChecked.flip(mAlive); invalidate(); }
+
+        ///Calls fn with each checked element, in the order they were added
+        template <typename Fn>
+        void forEachChecked(Fn&& fn) const
+        {
+            //Storage order is the order elements were added
+            mChecked.forEachSet([&](size_t slot) { fn(std::as_const(IList<T>::mElements[slot])); });
+
+            return;
+        }
+
+        virtual constexpr void scrollBy(int32_t amount) noexcept override
+        {
+            if (IList<T>::size() == 0)
+            {
+                return;
+            }
+
+            mSelection = std::clamp(mSelection + amount, 0, (int32_t)IList<T>::size() - 1);
+            //Keeps the selection in view, same as scrolling one step at a time
+            int32_t visibleRows = mRegion.h - 2;
+            if (mSelection < mScrollY)
+            {
+                mScrollY = mSelection;
+            }
+            else if (mSelection > mScrollY + visibleRows - 1)
+            {
+                mScrollY = mSelection - visibleRows + 1;
+            }
+
+            invalidate();
+
+            return;
+        }
+
+        ///Clicking a row selects it
+        virtual void doMouseButton(SDL_MouseButtonEvent& event, int32_t x, int32_t y) noexcept override
+        {
+            (void)x;
+            if (event.button != SDL_BUTTON_LEFT)
+            {
+                return;
+            }
+
+            //Index of the clicked row, the border is not part of the list
+            int32_t index = mScrollY + (y - mRegion.y - 1);
+            if (y <= mRegion.y || y >= mRegion.y + mRegion.h - 1 || index >= (int32_t)IList<T>::size())
+            {
+                return;
+            }
 
-            mRerender = true;
+            mSelection = index;
+            if ((SDL_GetModState() & KMOD_SHIFT) && mAnchor >= 0)
+            {
+                setCheckedRange(mAnchor, index, isChecked(mAnchor));
+            }
+            else
+            {
+                toggleCurrentElement();
+                mAnchor = index;
+            }
 
-            return element.mElement.second;
+            return;
         }
 
-        constexpr void showScrollbar() noexcept { mShowScrollbar = true; mRerender = true; }
-        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; mRerender = true; }
+        constexpr void showScrollbar() noexcept { mShowScrollbar = true; invalidate(); }
+        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; invalidate(); }
 
         //Getters
-        [[nodiscard]] constexpr const ListContainer<CheckListContainer<T>>& getCurrentElement() { return IList<CheckListContainer<T>>::mElements.at(mSelection); }
-        [[nodiscard]] constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        [[nodiscard]] constexpr const ListContainer<T>& getCurrentElement() { return IList<T>::getElement(mSelection); }
+        [[nodiscard]] bool isChecked(size_t index) const { return mChecked.test(slotAt(index)); }
+        [[nodiscard]] constexpr size_t getCheckedCount() const noexcept { return mChecked.count(); }
+        [[nodiscard]] virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        [[nodiscard]] virtual constexpr bool isOpaque() const noexcept override { return true; }
 
         //Setters
         constexpr void setRegion(const SDL_Rect& region) 
@@ -117,7 +281,7 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -128,6 +292,49 @@ namespace conslr::widgets
             mRegion{ 0, 0, 0, 0 }, mScrollY{ 0 }, mShowScrollbar{ true }
         {}
 
+        virtual void elementsChanged() override
+        {
+            //Bulk changes go through IList directly, so the bits are rebuilt from the list
+            size_t slots = IList<T>::mElements.size();
+            mChecked.resize(slots);
+            mAlive.resize(slots);
+            for (size_t slot = 0; slot < slots; slot++)
+            {
+                mAlive.set(slot, !IList<T>::isRemoved((uint32_t)slot));
+            }
+            mChecked.intersect(mAlive);
+            mAnchor = -1;
+
+            //Keeps the selection and scroll inside the list
+            int32_t count = (int32_t)IList<T>::size();
+            mSelection = std::clamp(mSelection, 0, std::max(0, count - 1));
+            mScrollY = std::clamp(mScrollY, 0, std::max(0, count - (mRegion.h - 2)));
+            invalidate();
+
+            return;
+        }
+
+        virtual void slotsMoved(const std::vector<uint32_t>& newSlots) override
+        {
+            DynamicBitset checked;
+            checked.resize(IList<T>::mElements.size());
+            for (size_t slot = 0; slot < newSlots.size(); slot++)
+            {
+                if (newSlots[slot] != IList<T>::REMOVED_SLOT && mChecked.test(slot))
+                {
+                    checked.set(newSlots[slot], true);
+                }
+            }
+            mChecked = std::move(checked);
+
+            //Compacted storage has no removed elements
+            mAlive.resize(0);
+            mAlive.resize(IList<T>::mElements.size());
+            mAlive.setAll(true);
+
+            return;
+        }
+
         virtual void render(Screen& screen) override
         {
             if (mRegion.w <= 2 || mRegion.h <= 2)
@@ -152,20 +359,22 @@ namespace conslr::widgets
                         mTheme->border);
             }
 
-            if (IList<CheckListContainer<T>>::size() == 0)
+            if (IList<T>::size() == 0)
             {
                 return;
             }
 
             //Render the elements
 
-            int32_t maxShown = std::min(freeHeight, (int32_t)IList<CheckListContainer<T>>::size());
+            int32_t maxShown = std::min(freeHeight, (int32_t)IList<T>::size());
             for (auto i = 0; i < maxShown; i++)
             {
-                const auto& element = IList<CheckListContainer<T>>::mElements.at(mScrollY + i);
-                screen.renderTextColor(xOffset, yOffset + i, freeWidth, "[ ]" + element.mName, mTheme->text);
+                uint32_t slot = slotAt(mScrollY + i);
+                const auto& element = IList<T>::mElements[slot];
+                screen.renderTextColor(xOffset, yOffset + i, freeWidth, "[ ]", mTheme->text);
+                screen.renderTextColor(xOffset + 3, yOffset + i, freeWidth - 3, element.mName, mTheme->text);
 
-                if (element.mElement.second)
+                if (mChecked.test(slot))
                 {
                     screen.setCellCharacter(xOffset + 1, yOffset +i, mTheme->selectionTick);
                 }
@@ -177,10 +386,10 @@ namespace conslr::widgets
                 screen.setCellBackground(xOffset + 1, yOffset + mSelection - mScrollY, mTheme->selection);
             }
 
-            if (mShowScrollbar && IList<CheckListContainer<T>>::size() > (size_t)freeHeight)
+            if (mShowScrollbar && IList<T>::size() > (size_t)freeHeight)
             {
-                double visiblePercent = (double)freeHeight / (double)IList<CheckListContainer<T>>::size(); //Percent of elements shown
-                double percentDown = (double)mScrollY / (double)IList<CheckListContainer<T>>::size(); //How far down the first element is
+                double visiblePercent = (double)freeHeight / (double)IList<T>::size(); //Percent of elements shown
+                double percentDown = (double)mScrollY / (double)IList<T>::size(); //How far down the first element is
 
                 //Render scrollbar
                 int32_t scrollbarOffset = percentDown * freeHeight;
@@ -192,9 +401,14 @@ namespace conslr::widgets
             return;
         }
 
+        [[nodiscard]] uint32_t slotAt(size_t index) const { return IList<T>::view().at(index); }
+
         SDL_Rect mRegion;
         int32_t mScrollY;
         bool mShowScrollbar;
+        DynamicBitset mChecked; //!<Checked elements by storage slot
+        DynamicBitset mAlive; //!<Elements in the list by storage slot, removed elements are zero
+        int32_t mAnchor = -1; //!<Row last clicked without shift, start of shift click ranges
     };
 
     ///
@@ -222,7 +436,7 @@ namespace conslr::widgets
 
         while (ss >> name >> val >> ticked)
         {
-            ptr->addElement({ std::stoll(val), ticked }, name);
+            ptr->addElement(std::stoll(val), name, ticked);
         }
 
         return;
@@ -240,7 +454,7 @@ namespace conslr::widgets
 
         while (ss >> name >> val >> ticked)
         {
-            ptr->addElement({ std::stoull(val), ticked }, name);
+            ptr->addElement(std::stoull(val), name, ticked);
         }
 
         return;
@@ -258,7 +472,7 @@ namespace conslr::widgets
 
         while (ss >> name >> val >> ticked)
         {
-            ptr->addElement({ std::stold(val), ticked }, name);
+            ptr->addElement(std::stold(val), name, ticked);
         }
 
         return;
@@ -276,7 +490,7 @@ namespace conslr::widgets
 
         while (ss >> name >> val >> ticked)
         {
-            ptr->addElement({ val, ticked }, name);
+            ptr->addElement(val, name, ticked);
         }
 
         return;
@@ -294,7 +508,7 @@ namespace conslr::widgets
 
         while (ss >> name >> val >> ticked)
         {
-            ptr->addElement({ val, ticked }, name);
+            ptr->addElement(val, name, ticked);
         }
 
         return;
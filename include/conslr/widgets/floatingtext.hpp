@@ -29,7 +29,7 @@ namespace conslr::widgets
         friend class conslr::WidgetManager;
 
         //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
         constexpr const std::string& getString() const noexcept { return mString; }
 
         constexpr void setRegion(const SDL_Rect& region) 
@@ -40,11 +40,11 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
-        constexpr void setString(const std::string& str) { mString = str; mRerender = true; }
+        constexpr void setString(const std::string& str) { mString = str; invalidate(); }
 
     protected:
         constexpr FloatingText(int32_t id, int32_t priority) noexcept :
@@ -0,0 +1,478 @@
+///
+///@file conslr/widgets/logview.hpp
+///@brief Defines the LogView widget
+///
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <stdexcept>
+
+#include <SDL_rect.h>
+
+#include "conslr/widget.hpp"
+#include "conslr/screen.hpp"
+#include "conslr/theme.hpp"
+#include "conslr/widgetmanager.hpp"
+#include "conslr/widgetfactory.hpp"
+#include "conslr/linebuffer.hpp"
+#include "conslr/compressedlines.hpp"
+#include "conslr/textsearch.hpp"
+#include "conslr/mpscqueue.hpp"
+
+namespace conslr::widgets
+{
+    ///
+    ///Shows the most recent lines of a log, for text appended at a high rate
+    ///
+    ///Lines are kept in a LineRingBuffer, so memory use is fixed and the oldest lines are dropped when it is full
+    ///pushLine may be called from any thread, the lines are added at the start of the next Console::render
+    ///While following, the view stays at the newest line, scrolling up stops following and scrolling back to the bottom resumes it
+    ///With scrollback enabled, lines dropped from the buffer are kept compressed in a CompressedLineStore and stay visible
+    ///Matches of find are highlighted, the search starts at the first visible line and continues over the following frames, including new lines
+    ///
+    class LogView : public IWidget, public IRenderable, public IScrollable, public IUpdatable
+    {
+    public:
+        friend class conslr::Screen;
+        friend class conslr::WidgetManager;
+
+        static constexpr size_t DEFAULT_MAX_LINES = 100000;
+        static constexpr size_t DEFAULT_ARENA_SIZE = 8 * 1024 * 1024;
+        static constexpr size_t SEARCH_BUDGET = 1 << 20; //!<Bytes searched each frame
+
+        ///Queues text to be appended at the next frame, safe to call from any thread
+        void pushLine(std::string line) { mQueue.push(std::move(line)); }
+
+        ///Appends text, split into lines at newlines, must be called from the thread rendering the console
+        void append(std::string_view text)
+        {
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = text.find('\n', start);
+                appendLine(text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+                if (end == std::string_view::npos)
+                {
+                    break;
+                }
+                start = end + 1;
+            }
+            invalidate();
+
+            return;
+        }
+
+        void clear()
+        {
+            mDropped += getLineCount();
+            mLines.clear();
+            if (mScrollback)
+            {
+                mScrollback->clear();
+            }
+            mScrollY = 0;
+            mFollow = true;
+            mSearch.setRange(mDropped, mDropped);
+            invalidate();
+
+            return;
+        }
+
+        ///Starts searching for query and highlights the matches, an empty query stops searching
+        ///
+        ///The visible lines are searched straight away, the rest over the following frames
+        void find(std::string_view query)
+        {
+            if (query.empty())
+            {
+                mSearch.clear();
+                invalidate();
+                return;
+            }
+
+            uint64_t first = mDropped + getFirstVisibleLine();
+            mSearch.start(query, mDropped, mDropped + getLineCount(), first);
+            mSearch.step([this](uint64_t line) { return getLine(line - mDropped); }, SEARCH_BUDGET);
+            mFindPosition = { first, -1 };
+            invalidate();
+
+            return;
+        }
+        ///Scrolls to the next match found so far, wrapping to the first
+        ///
+        ///@return false if no match has been found
+        bool findNext() { return moveToMatch(mSearch.findAfter(mFindPosition.line, mFindPosition.column)); }
+        ///Scrolls to the previous match found so far, wrapping to the last
+        ///
+        ///@return false if no match has been found
+        bool findPrev() { return moveToMatch(mSearch.findBefore(mFindPosition.line, mFindPosition.column)); }
+
+        virtual void scrollUp() noexcept override { scrollBy(-1); }
+        virtual void scrollDown() noexcept override { scrollBy(1); }
+        virtual void scrollBy(int32_t amount) noexcept override
+        {
+            int32_t bottom = getBottom();
+            int32_t first = mFollow ? bottom : mScrollY;
+
+            mScrollY = std::clamp(first + amount, 0, bottom);
+            mFollow = mScrollY == bottom;
+            invalidate();
+
+            return;
+        }
+
+        //Getters
+        [[nodiscard]] virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        [[nodiscard]] virtual constexpr bool isOpaque() const noexcept override { return true; }
+        [[nodiscard]] constexpr const LineRingBuffer& getLines() const noexcept { return mLines; }
+        ///@return Number of lines, including scrollback
+        [[nodiscard]] size_t getLineCount() const noexcept { return (mScrollback ? mScrollback->size() : 0) + mLines.size(); }
+        ///@param index Index of the line, 0 is the oldest line kept, including scrollback
+        ///@return The line, valid until the next call
+        [[nodiscard]] std::string_view getLine(size_t index)
+        {
+            if (index >= getLineCount())
+            {
+                throw std::out_of_range("Line index is out of bounds, index: " + std::to_string(index) + ", size: " + std::to_string(getLineCount()));
+            }
+
+            size_t scrollback = mScrollback ? mScrollback->size() : 0;
+            if (index < scrollback)
+            {
+                return (*mScrollback)[index];
+            }
+
+            return mLines[index - scrollback];
+        }
+        [[nodiscard]] bool hasScrollback() const noexcept { return mScrollback != nullptr; }
+        ///@return Bytes of compressed scrollback text
+        [[nodiscard]] size_t getScrollbackSize() const noexcept { return mScrollback ? mScrollback->getCompressedSize() : 0; }
+        ///@return The search, its line numbers are getLine indices plus getDroppedLines
+        [[nodiscard]] constexpr const TextSearch& getSearch() const noexcept { return mSearch; }
+        ///@return Number of lines dropped since construction
+        [[nodiscard]] constexpr uint64_t getDroppedLines() const noexcept { return mDropped; }
+        [[nodiscard]] constexpr bool getFollow() const noexcept { return mFollow; }
+        ///@return Index of the first shown line
+        [[nodiscard]] int32_t getFirstVisibleLine() const noexcept { return mFollow ? getBottom() : mScrollY; }
+
+        //Setters
+        constexpr void setRegion(const SDL_Rect& region)
+        {
+            if (region.w <= 2 || region.h <= 2)
+            {
+                throw std::invalid_argument("Region width and height must be greater than 2, width: " + std::to_string(region.w) + ", height: " + std::to_string(region.h));
+            }
+
+            mRegion = region;
+            invalidate();
+
+            return;
+        }
+        ///Follows the newest line if true
+        void setFollow(bool follow)
+        {
+            mFollow = follow;
+            mScrollY = getBottom();
+            invalidate();
+
+            return;
+        }
+        ///Replaces the line buffer, dropping every line
+        ///
+        ///@param maxLines Lines kept before the oldest is dropped
+        ///@param arenaSize Bytes of text kept before the oldest lines are dropped
+        void setCapacity(size_t maxLines, size_t arenaSize)
+        {
+            mDropped += getLineCount();
+            mLines = LineRingBuffer{ maxLines, arenaSize };
+            if (mScrollback)
+            {
+                mScrollback->clear();
+            }
+            mScrollY = 0;
+            mSearch.setRange(mDropped, mDropped);
+            invalidate();
+
+            return;
+        }
+        ///Keeps lines dropped from the line buffer compressed instead of discarding them, dropping any current scrollback
+        ///
+        ///@param maxLines Scrollback lines kept before the oldest are dropped, 0 for no limit
+        void setScrollback(bool enabled, size_t maxLines = 0)
+        {
+            if (mScrollback)
+            {
+                mDropped += mScrollback->size();
+                mSearch.setRange(mDropped, mDropped + mLines.size());
+            }
+
+            if (enabled)
+            {
+                mScrollback = std::make_unique<CompressedLineStore>(maxLines);
+            }
+            else
+            {
+                mScrollback.reset();
+            }
+            mScrollY = 0;
+            invalidate();
+
+            return;
+        }
+
+    protected:
+        LogView(int32_t id, int32_t priority) :
+            IWidget{ id, priority },
+            mRegion{ 0, 0, 0, 0 }, mScrollY{ 0 }, mFollow{ true },
+            mLines{ DEFAULT_MAX_LINES, DEFAULT_ARENA_SIZE }
+        {}
+
+        ///Appends the lines queued by pushLine
+        virtual void update() override
+        {
+            size_t count = mQueue.drain([this](std::string&& line) { appendLine(line); });
+            if (count != 0)
+            {
+                invalidate();
+            }
+
+            mSearch.setRange(mDropped, mDropped + getLineCount());
+            if (!mSearch.isDone())
+            {
+                mSearch.step([this](uint64_t line) { return getLine(line - mDropped); }, SEARCH_BUDGET);
+                invalidate();
+            }
+
+            return;
+        }
+
+        virtual void render(Screen& screen) override
+        {
+            if (mRegion.w <= 2 || mRegion.h <= 2)
+            {
+                throw std::runtime_error("Region width and height must be greater than 2, width: " + std::to_string(mRegion.w) + ", height: " + std::to_string(mRegion.h));
+            }
+
+            screen.fillRect(mRegion, mTheme->background, mTheme->border, 0);
+            screen.borderRect(mRegion, mTheme->borderHorizontal, mTheme->borderVertical, mTheme->borderCornerTl, mTheme->borderCornerTr, mTheme->borderCornerBl, mTheme->borderCornerBr);
+
+            if (mShowTitle)
+            {
+                screen.renderTextColor(
+                        mRegion.x + 1, mRegion.y,
+                        std::min(mRegion.w - 2, (int32_t)mTitle.size()),
+                        mTitle,
+                        mTheme->border);
+            }
+
+            int32_t first = getFirstVisibleLine();
+            int32_t shown = std::min(mRegion.h - 2, (int32_t)getLineCount() - first);
+            for (auto i = 0; i < shown; i++)
+            {
+                screen.renderTextColor(mRegion.x + 1, mRegion.y + 1 + i, mRegion.w - 2, getLine(first + i), mTheme->text);
+            }
+
+            //Search matches, the one last moved to uses the selection color
+            int32_t matchSize = mSearch.getQuery().size();
+            mSearch.forEachInLines(mDropped + first, mDropped + first + shown - 1, [&](const TextSearch::Match& match)
+                    {
+                        const SDL_Color& color = match == mFindPosition ? mTheme->selection : mTheme->highlight;
+                        int32_t y = mRegion.y + 1 + (int32_t)(match.line - mDropped) - first;
+                        for (auto x = match.column; x < std::min(match.column + matchSize, mRegion.w - 2); x++)
+                        {
+                            screen.setCellBackground(mRegion.x + 1 + x, y, color);
+                        }
+                    });
+
+            return;
+        }
+
+        void appendLine(std::string_view line)
+        {
+            size_t dropped = 0;
+            if (mScrollback)
+            {
+                mLines.push(line, [&](std::string_view old) { dropped += mScrollback->push(old); });
+            }
+            else
+            {
+                dropped = mLines.push(line);
+            }
+            mDropped += dropped;
+            //Keeps the shown lines in place while scrolled back
+            if (!mFollow)
+            {
+                mScrollY = std::max(0, mScrollY - (int32_t)dropped);
+            }
+
+            return;
+        }
+
+        bool moveToMatch(size_t index)
+        {
+            if (index == TextSearch::npos)
+            {
+                return false;
+            }
+
+            //Centers the match
+            mFindPosition = mSearch[index];
+            mScrollY = std::clamp((int32_t)(mFindPosition.line - mDropped) - (mRegion.h - 2) / 2, 0, getBottom());
+            mFollow = false;
+            invalidate();
+
+            return true;
+        }
+
+        ///@return First line shown when following
+        [[nodiscard]] int32_t getBottom() const noexcept { return std::max(0, (int32_t)getLineCount() - (mRegion.h - 2)); }
+
+        SDL_Rect mRegion;
+        int32_t mScrollY; //!<First shown line when not following
+        bool mFollow;
+        LineRingBuffer mLines;
+        std::unique_ptr<CompressedLineStore> mScrollback; //!<Lines dropped from mLines, null when disabled
+        uint64_t mDropped = 0; //!<Lines dropped since construction, search lines are numbered from the first line ever added
+        TextSearch mSearch;
+        TextSearch::Match mFindPosition = { 0, -1 }; //!<Match last moved to
+        MpscQueue<std::string> mQueue;
+    };
+
+    inline std::pair<std::string, int32_t> constructLogView(WidgetManager& wm, const WidgetParameterMap& params)
+    {
+        int priority = 0;
+        if (params.contains("priority"))
+        {
+            priority = std::stoi(params.at("priority"));
+        }
+        auto wptr = wm.createWidget<LogView>(priority);
+        auto ptr = wptr.lock();
+
+        if (params.contains("visible"))
+        {
+            if (params.at("visible") == "true")
+            {
+                ptr->show();
+            }
+            else if (params.at("visible") == "false")
+            {
+                ptr->hide();
+            }
+            else
+            {
+                throw std::invalid_argument("Param visible must be \"true\" or \"false\"");
+            }
+        }
+
+        if (params.contains("showtitle"))
+        {
+            if (params.at("showtitle") == "true")
+            {
+                ptr->showTitle();
+            }
+            else if (params.at("showtitle") == "false")
+            {
+                ptr->hideTitle();
+            }
+            else
+            {
+                throw std::invalid_argument("Param showtitle must be \"true\" or \"false\"");
+            }
+        }
+
+        if (params.contains("active"))
+        {
+            if (params.at("active") == "true")
+            {
+                ptr->setActive(true);
+            }
+            else if (params.at("active") == "false")
+            {
+                ptr->setActive(false);
+            }
+            else
+            {
+                throw std::invalid_argument("Param active must be \"true\" or \"false\"");
+            }
+        }
+
+        if (params.contains("capacity"))
+        {
+            std::stringstream ss{ params.at("capacity") };
+            size_t maxLines;
+            size_t arenaSize;
+
+            ss >> maxLines >> arenaSize;
+            if (ss.fail())
+            {
+                throw std::invalid_argument("Param capacity must be in the format of \"maxlines arenabytes\"");
+            }
+
+            ptr->setCapacity(maxLines, arenaSize);
+        }
+
+        if (params.contains("scrollback"))
+        {
+            std::stringstream ss{ params.at("scrollback") };
+            size_t maxLines;
+
+            ss >> maxLines;
+            if (ss.fail())
+            {
+                throw std::invalid_argument("Param scrollback must be in the format of \"maxlines\", 0 for no limit");
+            }
+
+            ptr->setScrollback(true, maxLines);
+        }
+
+        if (params.contains("follow"))
+        {
+            if (params.at("follow") == "true")
+            {
+                ptr->setFollow(true);
+            }
+            else if (params.at("follow") == "false")
+            {
+                ptr->setFollow(false);
+            }
+            else
+            {
+                throw std::invalid_argument("Param follow must be \"true\" or \"false\"");
+            }
+        }
+
+        if (params.contains("title"))
+        {
+            ptr->setTitle(params.at("title"));
+        }
+
+        if (params.contains("region"))
+        {
+            std::stringstream ss{ params.at("region") };
+            int32_t x;
+            int32_t y;
+            int32_t w;
+            int32_t h;
+
+            ss >> x >> y >> w >> h;
+            if (ss.fail())
+            {
+                throw std::invalid_argument("Param region must be in the format of \"intx inty intw inth\"");
+            }
+
+            ptr->setRegion({ x, y, w, h });
+        }
+
+        if (params.contains("name"))
+        {
+            return { params.at("name"), ptr->getId() };
+        }
+        else
+        {
+            return { "unnamed", ptr->getId() };
+        }
+    }
+}
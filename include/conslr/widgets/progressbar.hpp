@@ -5,8 +5,10 @@
 #pragma once
 
 #include <algorithm>
+#include <charconv>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sstream>
 
 #include <SDL.h>
@@ -28,14 +30,15 @@ namespace conslr::widgets
         friend class conslr::Screen;
         friend class conslr::WidgetManager;
 
-        constexpr void addValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(mCurrentValue + val, 0, mMaxValue); mRerender = true; }
-        constexpr void removeValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(mCurrentValue - val, 0, mMaxValue); mRerender = true; }
+        constexpr void addValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(mCurrentValue + val, 0, mMaxValue); invalidate(); }
+        constexpr void removeValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(mCurrentValue - val, 0, mMaxValue); invalidate(); }
 
-        constexpr void showPercent() noexcept { mShowPercent = true; mRerender = true; }
-        constexpr void hidePercent() noexcept { mShowPercent = false; mRerender = true; }
+        constexpr void showPercent() noexcept { mShowPercent = true; invalidate(); }
+        constexpr void hidePercent() noexcept { mShowPercent = false; invalidate(); }
 
         //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        virtual constexpr bool isOpaque() const noexcept override { return true; }
         constexpr const int32_t& getCurrentValue() const noexcept { return mCurrentValue; }
         constexpr const int32_t& getMaxValue() const noexcept { return mMaxValue; }
 
@@ -48,12 +51,12 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
-        constexpr void setCurrentValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(val, 0, mMaxValue); mRerender = true; }
-        constexpr void setMaxValue(const int32_t& val) noexcept { mMaxValue = std::max(val, 1); mRerender = true; }
+        constexpr void setCurrentValue(const int32_t& val) noexcept { mCurrentValue = std::clamp(val, 0, mMaxValue); invalidate(); }
+        constexpr void setMaxValue(const int32_t& val) noexcept { mMaxValue = std::max(val, 1); invalidate(); }
 
     protected:
         constexpr ProgressBar(int32_t id, int32_t priority) noexcept :
@@ -94,9 +97,10 @@ namespace conslr::widgets
             //Render percent
             if (mShowPercent && mRegion.w - 2 >= 4)
             {
-                std::string p{ "%" };
-                p += std::to_string((int32_t)(percent * 100));
-                
+                char buffer[12] = { '%' };
+                auto result = std::to_chars(buffer + 1, buffer + sizeof(buffer), (int32_t)(percent * 100));
+                std::string_view p{ buffer, (size_t)(result.ptr - buffer) };
+
                 int32_t percentX = std::max(0, (int32_t)(((mRegion.w - 2) / 2) - (p.size() / 2)));
                 
                 screen.renderTextColor(
@@ -21,11 +21,11 @@
 namespace conslr::widgets
 {
     ///Allows the user to create a radio list of items
-    ///Internal note, mSelection refers to what is being hovered (taken from scrollable), mChosenElement refers to the element of the list that is ticked
+    ///Internal note, mSelection refers to what is being hovered (taken from scrollable), mChosenElement is the id of the element of the list that is ticked
     ///
     ///@tparam Type of the elements of the ScrollList
     template<typename T>
-    class RadioList : public IWidget, public IRenderable, public IScrollable, public IList<T>
+    class RadioList : public IWidget, public IRenderable, public IScrollable, public IMouseInput, public IList<T>
     {
     public:
         friend class conslr::Screen;
@@ -34,7 +34,7 @@ namespace conslr::widgets
         virtual void addElement(const T& t, const std::string& name) override
         {
             IList<T>::addElement(t, name);
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -42,6 +42,10 @@ namespace conslr::widgets
         virtual void removeElement(size_t index) override
         {
             IList<T>::removeElement(index);
+            if (mChosenElement >= 0 && IList<T>::findElement(mChosenElement) == nullptr)
+            {
+                mChosenElement = -1;
+            }
             if ((size_t)mSelection == IList<T>::size())
             {
                 //If the removed element was the last, and it was selected, scroll up
@@ -52,7 +56,42 @@ namespace conslr::widgets
             {
                 mScrollY--;
             }
-            mRerender = true;
+            invalidate();
+
+            return;
+        }
+
+        virtual void setFilter(std::string_view query) override
+        {
+            IList<T>::setFilter(query);
+            //The first match is selected
+            mSelection = 0;
+            mScrollY = 0;
+            invalidate();
+
+            return;
+        }
+
+        ///Sorts the list with IList::sortBy, the selected element stays selected at the same row
+        template <typename KeyFn>
+        void sortBy(KeyFn keyFn)
+        {
+            int32_t count = (int32_t)IList<T>::size();
+            if (count == 0)
+            {
+                //Elements hidden by a filter are still sorted
+                IList<T>::sortBy(std::move(keyFn));
+                return;
+            }
+
+            uint32_t selected = IList<T>::view()[mSelection];
+            int32_t row = mSelection - mScrollY;
+
+            IList<T>::sortBy(std::move(keyFn));
+
+            mSelection = (int32_t)IList<T>::findSlot(selected);
+            mScrollY = std::clamp(mSelection - row, 0, std::max(0, count - (mRegion.h - 2)));
+            invalidate();
 
             return;
         }
@@ -70,7 +109,7 @@ namespace conslr::widgets
                 mScrollY--;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -89,24 +128,86 @@ namespace conslr::widgets
                 mScrollY++;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
         constexpr void chooseElement() noexcept
         {
-            mChosenElement = mSelection;
+            if (IList<T>::size() == 0)
+            {
+                return;
+            }
+
+            mChosenElement = (int64_t)IList<T>::getElement(mSelection).mIndex;
+
+            invalidate();
+            return;
+        }
+
+        virtual constexpr void scrollBy(int32_t amount) noexcept override
+        {
+            if (IList<T>::size() == 0)
+            {
+                return;
+            }
+
+            mSelection = std::clamp(mSelection + amount, 0, (int32_t)IList<T>::size() - 1);
+            //Keeps the selection in view, same as scrolling one step at a time
+            int32_t visibleRows = mRegion.h - 2;
+            if (mSelection < mScrollY)
+            {
+                mScrollY = mSelection;
+            }
+            else if (mSelection > mScrollY + visibleRows - 1)
+            {
+                mScrollY = mSelection - visibleRows + 1;
+            }
+
+            invalidate();
+
+            return;
+        }
+
+        ///Clicking a row selects it
+        virtual void doMouseButton(SDL_MouseButtonEvent& event, int32_t x, int32_t y) noexcept override
+        {
+            (void)x;
+            if (event.button != SDL_BUTTON_LEFT)
+            {
+                return;
+            }
+
+            //Index of the clicked row, the border is not part of the list
+            int32_t index = mScrollY + (y - mRegion.y - 1);
+            if (y <= mRegion.y || y >= mRegion.y + mRegion.h - 1 || index >= (int32_t)IList<T>::size())
+            {
+                return;
+            }
+
+            mSelection = index;
+            chooseElement();
 
-            mRerender = true;
             return;
         }
 
-        constexpr void showScrollbar() noexcept { mShowScrollbar = true; mRerender = true; }
-        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; mRerender = true; }
+        constexpr void showScrollbar() noexcept { mShowScrollbar = true; invalidate(); }
+        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; invalidate(); }
 
         //Getters
-        [[nodiscard]] constexpr const ListContainer<T>& getCurrentElement() { return IList<T>::mElements.at(mChosenElement); }
-        [[nodiscard]] constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        ///@return The chosen element, it is found even if the filter hides it
+        [[nodiscard]] const ListContainer<T>& getCurrentElement()
+        {
+            const ListContainer<T>* element = mChosenElement >= 0 ? IList<T>::findElement(mChosenElement) : nullptr;
+            if (element == nullptr)
+            {
+                throw std::runtime_error("No element is chosen, id: " + std::to_string(getId()));
+            }
+
+            return *element;
+        }
+        [[nodiscard]] virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        [[nodiscard]] virtual constexpr bool isOpaque() const noexcept override { return true; }
 
         //Setters
         constexpr void setRegion(const SDL_Rect& region) 
@@ -117,7 +218,7 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -129,6 +230,21 @@ namespace conslr::widgets
             mChosenElement{ -1 }
         {}
 
+        virtual void elementsChanged() override
+        {
+            //Keeps the selection and scroll inside the list
+            int32_t count = (int32_t)IList<T>::size();
+            mSelection = std::clamp(mSelection, 0, std::max(0, count - 1));
+            mScrollY = std::clamp(mScrollY, 0, std::max(0, count - (mRegion.h - 2)));
+            if (mChosenElement >= 0 && IList<T>::findElement(mChosenElement) == nullptr)
+            {
+                mChosenElement = -1;
+            }
+            invalidate();
+
+            return;
+        }
+
         virtual void render(Screen& screen) override
         {
             if (mRegion.w <= 2 || mRegion.h <= 2)
@@ -163,10 +279,11 @@ namespace conslr::widgets
             int32_t maxShown = std::min(freeHeight, (int32_t)IList<T>::size());
             for (auto i = 0; i < maxShown; i++)
             {
-                const auto& element = IList<T>::mElements.at(mScrollY + i);
-                screen.renderTextColor(xOffset, yOffset + i, freeWidth, "[ ]" + element.mName, mTheme->text);
+                const auto& element = IList<T>::getElement(mScrollY + i);
+                screen.renderTextColor(xOffset, yOffset + i, freeWidth, "[ ]", mTheme->text);
+                screen.renderTextColor(xOffset + 3, yOffset + i, freeWidth - 3, element.mName, mTheme->text);
 
-                if (mChosenElement == mScrollY + i)
+                if (mChosenElement == (int64_t)element.mIndex)
                 {
                     screen.setCellCharacter(xOffset + 1, yOffset + i, mTheme->selectionTick);
                 }
@@ -196,7 +313,7 @@ namespace conslr::widgets
         SDL_Rect mRegion;
         int32_t mScrollY;
         bool mShowScrollbar;
-        int32_t mChosenElement; //!<Element currently chosen in the list, negative numbers are no selection
+        int64_t mChosenElement; //!<Id of the element currently chosen in the list, negative numbers are no selection
     };
 
     ///
@@ -24,9 +24,11 @@ namespace conslr::widgets
 {
     ///Allows the user to create a list of items
     ///
+    ///The list either owns its elements through IList, or is virtual and reads its rows from an IListProvider
+    ///
     ///@tparam Type of the elements of the ScrollList
     template<typename T>
-    class ScrollList : public IWidget, public IRenderable, public IScrollable, public IList<T>
+    class ScrollList : public IWidget, public IRenderable, public IScrollable, public IMouseInput, public IList<T>
     {
     public:
         friend class conslr::Screen;
@@ -35,7 +37,7 @@ namespace conslr::widgets
         virtual void addElement(const T& t, const std::string& name) override
         {
             IList<T>::addElement(t, name);
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -43,6 +45,12 @@ namespace conslr::widgets
         virtual void removeElement(size_t index) override
         {
             IList<T>::removeElement(index);
+            if (mProvider != nullptr)
+            {
+                //The shown rows are the provider's, the selection indexes them
+                return;
+            }
+
             if ((size_t)mSelection == IList<T>::size())
             {
                 //If the removed element was the last, and it was selected, scroll up
@@ -53,14 +61,57 @@ namespace conslr::widgets
             {
                 mScrollY--;
             }
-            mRerender = true;
+            invalidate();
+
+            return;
+        }
+
+        virtual void setFilter(std::string_view query) override
+        {
+            IList<T>::setFilter(query);
+            if (mProvider != nullptr)
+            {
+                //The filter applies to the owned elements, which are not shown
+                return;
+            }
+
+            //The first match is selected
+            mSelection = 0;
+            mScrollY = 0;
+            invalidate();
+
+            return;
+        }
+
+        ///Sorts the list with IList::sortBy, the selected element stays selected at the same row
+        ///
+        ///Virtual lists only sort their owned elements, the selection and scroll of the provider's rows are kept
+        template <typename KeyFn>
+        void sortBy(KeyFn keyFn)
+        {
+            int32_t count = (int32_t)IList<T>::size();
+            if (count == 0 || mProvider != nullptr)
+            {
+                //Elements hidden by a filter or a provider are still sorted
+                IList<T>::sortBy(std::move(keyFn));
+                return;
+            }
+
+            uint32_t selected = IList<T>::view()[mSelection];
+            int32_t row = mSelection - mScrollY;
+
+            IList<T>::sortBy(std::move(keyFn));
+
+            mSelection = (int32_t)IList<T>::findSlot(selected);
+            mScrollY = std::clamp(mSelection - row, 0, std::max(0, count - (mRegion.h - 2)));
+            invalidate();
 
             return;
         }
 
-        virtual constexpr void scrollUp() noexcept override
+        virtual void scrollUp() noexcept override
         {
-            if (IList<T>::size() == 0)
+            if (rowCount() == 0)
             {
                 return;
             }
@@ -71,18 +122,18 @@ namespace conslr::widgets
                 mScrollY--;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
-        virtual constexpr void scrollDown() noexcept override
+        virtual void scrollDown() noexcept override
         {
-            if (IList<T>::size() == 0)
+            if (rowCount() == 0)
             {
                 return;
             }
 
-            mSelection = std::min((int32_t)IList<T>::size() - 1, mSelection + 1);
+            mSelection = std::min((int32_t)rowCount() - 1, mSelection + 1);
             //Subtracted by 1 to get the last element
             //without it it would be past the last element
             if (mSelection > mScrollY + mRegion.h - 2 - 1)
@@ -90,17 +141,112 @@ namespace conslr::widgets
                 mScrollY++;
             }
 
-            mRerender = true;
+            invalidate();
 
             return;
         }
 
-        constexpr void showScrollbar() noexcept { mShowScrollbar = true; mRerender = true; }
-        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; mRerender = true; }
+        virtual void scrollBy(int32_t amount) noexcept override
+        {
+            if (rowCount() == 0)
+            {
+                return;
+            }
+
+            mSelection = std::clamp(mSelection + amount, 0, (int32_t)rowCount() - 1);
+            //Keeps the selection in view, same as scrolling one step at a time
+            int32_t visibleRows = mRegion.h - 2;
+            if (mSelection < mScrollY)
+            {
+                mScrollY = mSelection;
+            }
+            else if (mSelection > mScrollY + visibleRows - 1)
+            {
+                mScrollY = mSelection - visibleRows + 1;
+            }
+
+            invalidate();
+
+            return;
+        }
+
+        ///Clicking a row selects it
+        virtual void doMouseButton(SDL_MouseButtonEvent& event, int32_t x, int32_t y) noexcept override
+        {
+            (void)x;
+            if (event.button != SDL_BUTTON_LEFT)
+            {
+                return;
+            }
+
+            //Index of the clicked row, the border is not part of the list
+            int32_t index = mScrollY + (y - mRegion.y - 1);
+            if (y <= mRegion.y || y >= mRegion.y + mRegion.h - 1 || index >= (int32_t)rowCount())
+            {
+                return;
+            }
+
+            mSelection = index;
+            invalidate();
+
+            return;
+        }
+
+        ///Makes the list virtual, rows are read from the provider instead of the owned elements
+        ///
+        ///The owned elements are kept but not shown until the provider is cleared
+        ///While virtual, addElement, removeElement, setFilter, sortBy and the other IList functions still change
+        ///the owned elements, but leave the selection and scroll of the provider's rows alone,
+        ///getCurrentElement throws, use getCurrentValue
+        ///
+        ///@param provider Provider of the rows, nullptr returns to the owned elements
+        void setProvider(std::shared_ptr<IListProvider<T>> provider)
+        {
+            mProvider = std::move(provider);
+            mSelection = 0;
+            mScrollY = 0;
+            invalidate();
+
+            return;
+        }
+
+        ///Call when the provider's rows changed, keeps the selection if it is still in the list
+        void providerChanged() { elementsChanged(); }
+
+        constexpr void showScrollbar() noexcept { mShowScrollbar = true; invalidate(); }
+        constexpr void hideScrollbar() noexcept { mShowScrollbar = false; invalidate(); }
 
         //Getters
-        [[nodiscard]] constexpr const ListContainer<T>& getCurrentElement() { return IList<T>::mElements.at(mSelection); }
-        [[nodiscard]] constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        ///Not available for virtual lists, see getCurrentValue
+        [[nodiscard]] const ListContainer<T>& getCurrentElement()
+        {
+            if (mProvider != nullptr)
+            {
+                throw std::runtime_error("ScrollList is virtual, use getCurrentValue, id: " + std::to_string(getId()));
+            }
+
+            return IList<T>::getElement(mSelection);
+        }
+        ///Value of the selected row, for both owned and virtual lists
+        [[nodiscard]] T getCurrentValue()
+        {
+            if (mProvider != nullptr)
+            {
+                if ((size_t)mSelection >= mProvider->size())
+                {
+                    throw std::runtime_error("Selection is out of bounds, selection: " + std::to_string(mSelection) + ", size: " + std::to_string(mProvider->size()));
+                }
+
+                return mProvider->getElement(mSelection);
+            }
+
+            return IList<T>::getElement(mSelection).mElement;
+        }
+        [[nodiscard]] constexpr const std::shared_ptr<IListProvider<T>>& getProvider() const noexcept { return mProvider; }
+        ///Number of rows shown, from the provider if virtual
+        [[nodiscard]] size_t rowCount() const { return mProvider != nullptr ? mProvider->size() : IList<T>::size(); }
+        [[nodiscard]] virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        [[nodiscard]] virtual constexpr bool isOpaque() const noexcept override { return true; }
 
         //Setters
         constexpr void setRegion(const SDL_Rect& region) 
@@ -111,7 +257,7 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
@@ -122,6 +268,17 @@ namespace conslr::widgets
             mRegion{ 0, 0, 0, 0 }, mScrollY{ 0 }, mShowScrollbar{ true }
         {}
 
+        virtual void elementsChanged() override
+        {
+            //Keeps the selection and scroll inside the list
+            int32_t count = (int32_t)rowCount();
+            mSelection = std::clamp(mSelection, 0, std::max(0, count - 1));
+            mScrollY = std::clamp(mScrollY, 0, std::max(0, count - (mRegion.h - 2)));
+            invalidate();
+
+            return;
+        }
+
         virtual void render(Screen& screen) override
         {
             if (mRegion.w <= 2 || mRegion.h <= 2)
@@ -146,18 +303,20 @@ namespace conslr::widgets
                         mTheme->border);
             }
 
-            if (IList<T>::size() == 0)
+            //Read once, a provider may be slow to count its rows
+            size_t count = rowCount();
+            if (count == 0)
             {
                 return;
             }
 
             //Render the elements
 
-            int32_t maxShown = std::min(freeHeight, (int32_t)IList<T>::size());
+            int32_t maxShown = std::min(freeHeight, (int32_t)count - mScrollY);
             for (auto i = 0; i < maxShown; i++)
             {
-                const auto& element = IList<T>::mElements.at(mScrollY + i);
-                screen.renderTextColor(xOffset, yOffset + i, freeWidth, element.mName, mTheme->text);
+                std::string_view name = mProvider != nullptr ? mProvider->getName(mScrollY + i) : std::string_view{ IList<T>::getElement(mScrollY + i).mName };
+                screen.renderTextColor(xOffset, yOffset + i, freeWidth, name, mTheme->text);
             }
 
             //Current selection
@@ -166,10 +325,10 @@ namespace conslr::widgets
                 screen.setCellBackground(xOffset, yOffset + mSelection - mScrollY, mTheme->selection);
             }
 
-            if (mShowScrollbar && IList<T>::size() > (size_t)freeHeight)
+            if (mShowScrollbar && count > (size_t)freeHeight)
             {
-                double visiblePercent = (double)freeHeight / (double)IList<T>::size(); //Percent of elements shown
-                double percentDown = (double)mScrollY / (double)IList<T>::size(); //How far down the first element is
+                double visiblePercent = (double)freeHeight / (double)count; //Percent of elements shown
+                double percentDown = (double)mScrollY / (double)count; //How far down the first element is
 
                 //Render scrollbar
                 int32_t scrollbarOffset = percentDown * freeHeight;
@@ -184,6 +343,7 @@ namespace conslr::widgets
         SDL_Rect mRegion;
         int32_t mScrollY;
         bool mShowScrollbar;
+        std::shared_ptr<IListProvider<T>> mProvider; //!<Rows of a virtual list, nullptr when the owned elements are shown
     };
 
     ///
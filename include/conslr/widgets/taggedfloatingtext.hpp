@@ -27,7 +27,7 @@ namespace conslr::widgets
         friend class conslr::WidgetManager;
 
         //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
         constexpr const TaggedString& getString() const noexcept { return mString; }
         constexpr const TagSet& getTags() const noexcept { return mTags; }
 
@@ -40,12 +40,12 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
 
             return;
         }
-        constexpr void setString(const TaggedString& str) { mString = str; mRerender = true; }
-        constexpr void setTags(const TagSet& tags) { mTags = tags; mRerender = true; }
+        constexpr void setString(const TaggedString& str) { mString = str; invalidate(); }
+        constexpr void setTags(const TagSet& tags) { mTags = tags; invalidate(); }
 
     protected:
         constexpr TaggedFloatingText(int32_t id, int32_t priority) noexcept :
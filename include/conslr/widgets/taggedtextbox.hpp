@@ -15,12 +15,14 @@
 #include "conslr/taggedstring.hpp"
 #include "conslr/widgetmanager.hpp"
 #include "conslr/widgetfactory.hpp"
+#include "conslr/wraplayout.hpp"
 
 namespace conslr::widgets
 {
     ///
     ///Renders a simple tagged text box
     ///
+    ///Text is wrapped at word boundaries like TextBox
     class TaggedTextBox : public IWidget, public IRenderable
     {
     public:
@@ -28,9 +30,11 @@ namespace conslr::widgets
         friend class conslr::WidgetManager;
 
         //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        virtual constexpr bool isOpaque() const noexcept override { return true; }
         constexpr const TaggedString& getString() const noexcept { return mString; }
         constexpr const TagSet& getTags() const noexcept { return mTags; }
+        constexpr bool getWordWrap() const noexcept { return mWordWrap; }
 
         //Setters
         constexpr void setRegion(const SDL_Rect& region) 
@@ -41,12 +45,25 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
+
+            return;
+        }
+        constexpr void setString(const TaggedString& str) { mString = str; mRevision++; invalidate(); }
+        constexpr void setTags(const TagSet& tags) { mTags = tags; invalidate(); }
+        ///Wrap at spaces if true, otherwise wrap at the region width
+        constexpr void setWordWrap(bool wordWrap) { mWordWrap = wordWrap; invalidate(); }
+
+        ///Appends to the string, only the last row and onwards are wrapped again
+        constexpr void appendString(const TaggedString& str)
+        {
+            mLayout.textAppended((int32_t)mString.str.size(), mRevision);
+            mString += str;
+            mRevision++;
+            invalidate();
 
             return;
         }
-        constexpr void setString(const TaggedString& str) { mString = str; }
-        constexpr void setTags(const TagSet& tags) { mTags = tags; }
 
     protected:
         constexpr TaggedTextBox(int32_t id, int32_t priority) noexcept :
@@ -74,11 +91,16 @@ namespace conslr::widgets
                         );
             }
 
-            screen.renderMultilineTextTagged(
-                    mRegion.x + 1, mRegion.y + 1,
-                    mRegion.w - 2, mRegion.h - 2,
-                    mString,
-                    mTags);
+            std::span<const TaggedChar> str{ mString.str };
+            const auto& rows = mLayout.update(str, mRevision, mRegion.w - 2, mWordWrap);
+            for (auto i = 0; i < std::min((int32_t)rows.size(), mRegion.h - 2); i++)
+            {
+                screen.renderTextTagged(
+                        mRegion.x + 1, mRegion.y + 1 + i,
+                        mRegion.w - 2,
+                        str.subspan(rows[i].start, rows[i].length),
+                        mTags);
+            }
 
             return;
         }
@@ -86,6 +108,9 @@ namespace conslr::widgets
         SDL_Rect mRegion;
         TaggedString mString;
         TagSet mTags;
+        uint64_t mRevision = 0; //!<Incremented on every string change, keys mLayout
+        WrapLayout mLayout;
+        bool mWordWrap = true;
     };
 
     inline std::pair<std::string, int32_t> constructTaggedTextBox(WidgetManager& wm, const WidgetParameterMap& params)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <stdexcept>
 
@@ -15,12 +16,14 @@
 #include "conslr/theme.hpp"
 #include "conslr/widgetmanager.hpp"
 #include "conslr/widgetfactory.hpp"
+#include "conslr/wraplayout.hpp"
 
 namespace conslr::widgets
 {
     ///
     ///Renders a simple text box
     ///
+    ///Text is wrapped at word boundaries, the wrapped rows are cached until the text or the region width changes
     class TextBox : public IWidget, public IRenderable
     {
     public:
@@ -28,8 +31,10 @@ namespace conslr::widgets
         friend class conslr::WidgetManager;
 
         //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        virtual constexpr bool isOpaque() const noexcept override { return true; }
         constexpr const std::string& getString() const noexcept { return mString; }
+        constexpr bool getWordWrap() const noexcept { return mWordWrap; }
 
         //Setters
         constexpr void setRegion(const SDL_Rect& region)
@@ -40,11 +45,24 @@ namespace conslr::widgets
             }
 
             mRegion = region;
-            mRerender = true;
+            invalidate();
+
+            return;
+        }
+        constexpr void setString(const std::string& str) { mString = str; mRevision++; invalidate(); }
+        ///Wrap at spaces if true, otherwise wrap at the region width
+        constexpr void setWordWrap(bool wordWrap) { mWordWrap = wordWrap; invalidate(); }
+
+        ///Appends to the string, only the last row and onwards are wrapped again
+        constexpr void appendString(std::string_view str)
+        {
+            mLayout.textAppended((int32_t)mString.size(), mRevision);
+            mString.append(str);
+            mRevision++;
+            invalidate();
 
             return;
         }
-        constexpr void setString(const std::string& str) { mString = str; mRerender = true; }
 
     protected:
         constexpr TextBox(int32_t id, int32_t priority) noexcept :
@@ -72,17 +90,25 @@ namespace conslr::widgets
                         );
             }
 
-            screen.renderMultilineTextColor(
-                    mRegion.x + 1, mRegion.y + 1,
-                    mRegion.w - 2, mRegion.h - 2,
-                    mString,
-                    mTheme->text);
+            const auto& rows = mLayout.update(std::span<const char>{ mString }, mRevision, mRegion.w - 2, mWordWrap);
+            std::string_view str{ mString };
+            for (auto i = 0; i < std::min((int32_t)rows.size(), mRegion.h - 2); i++)
+            {
+                screen.renderTextColor(
+                        mRegion.x + 1, mRegion.y + 1 + i,
+                        mRegion.w - 2,
+                        str.substr(rows[i].start, rows[i].length),
+                        mTheme->text);
+            }
 
             return;
         }
 
         SDL_Rect mRegion;
         std::string mString;
+        uint64_t mRevision = 0; //!<Incremented on every string change, keys mLayout
+        WrapLayout mLayout;
+        bool mWordWrap = true;
     };
 
     inline std::pair<std::string, int32_t> constructTextBox(WidgetManager& wm, const WidgetParameterMap& params)
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
 
@@ -17,6 +19,8 @@
 #include "conslr/theme.hpp"
 #include "conslr/widgetmanager.hpp"
 #include "conslr/widgetfactory.hpp"
+#include "conslr/textsearch.hpp"
+#include "conslr/textrows.hpp"
 
 namespace conslr::widgets
 {
@@ -25,12 +29,19 @@ namespace conslr::widgets
     ///Only newline characters are treated as a special character
     ///Other characters such as \t are treated as a index for a character to render
     ///Note: Scrollbar may be inaccurate for certain amounts of rows, not terribly inaccurate so it has been left to be fixed later
-    class TextInput : public IWidget, public IRenderable, public ITextInput
+    ///Matches of find are highlighted, large texts are searched over several frames starting at the first visible row
+    ///Rows are kept in a TextRows, so editing and finding a row do not depend on the size of the text
+    ///With word wrap, rows are broken at the last space that fits and the cursor moves by visual lines,
+    ///only rows near the view are laid out and an edit only lays out its own row again
+    class TextInput : public IWidget, public IRenderable, public ITextInput, public IMouseInput, public IUpdatable
     {
     public:
         friend class conslr::Screen;
         friend class conslr::WidgetManager;
 
+        static constexpr size_t SEARCH_BUDGET = 1 << 20; //!<Bytes searched each frame
+        static constexpr size_t WRAP_CACHE_ROWS = 1024; //!<Rows laid out for word wrap kept at once
+
         virtual void doTextInput(SDL_TextInputEvent& event) noexcept override
         {
             if (!mActive)
@@ -38,111 +49,242 @@ namespace conslr::widgets
                 return;
             }
 
-            mRows.at(mCurrentRow).insert(mSelection, event.text);
+            mRows.insertText(mCurrentRow, mSelection, event.text);
             mSelection += strlen(event.text);
 
-            mRerender = true;
+            rowChanged(mCurrentRow);
+            invalidate();
 
             return;
         }
+        ///Not checked for mActive, the console only holds back text while the widget is active
+        virtual void insertText(std::string_view text) noexcept override
+        {
+            mRows.insertText(mCurrentRow, mSelection, text);
+            mSelection += text.size();
 
-        virtual constexpr void doKeyLeft() noexcept
+            rowChanged(mCurrentRow);
+            invalidate();
+
+            return;
+        }
+
+        virtual void doKeyLeft() noexcept override
         {
             if (!mActive) { return; }
             mSelection = std::max(0, mSelection - 1);
-            mRerender = true;
+            invalidate();
             return;
         }
-        virtual constexpr void doKeyRight() noexcept
+        virtual void doKeyRight() noexcept override
         {
             if (!mActive) { return; }
-            mSelection = std::min((int32_t)mRows.at(mCurrentRow).size(), mSelection + 1);
-            mRerender = true;
+            mSelection = std::min((int32_t)mRows[mCurrentRow].size(), mSelection + 1);
+            invalidate();
             return;
         }
-        virtual constexpr void doKeyUp() noexcept
+        virtual void doKeyUp() noexcept override
         {
             if (!mActive) { return; }
+            if (mWordWrap)
+            {
+                auto [line, x] = getVisualPosition(mCurrentRow, mSelection);
+                if (line != 0)
+                {
+                    mSelection = getVisualColumn(mCurrentRow, line - 1, x);
+                }
+                else if (mCurrentRow != 0)
+                {
+                    mCurrentRow--;
+                    mSelection = getVisualColumn(mCurrentRow, (int32_t)getWrap(mCurrentRow).size() - 1, x);
+                }
+                invalidate();
+                return;
+            }
             mCurrentRow = std::max(0, mCurrentRow - 1);
-            mSelection = std::min((int32_t)mRows.at(mCurrentRow).size(), mSelection);
-            mRerender = true;
+            mSelection = std::min((int32_t)mRows[mCurrentRow].size(), mSelection);
+            invalidate();
             return;
         }
-        virtual constexpr void doKeyDown() noexcept
+        virtual void doKeyDown() noexcept override
         {
             if (!mActive) { return; }
+            if (mWordWrap)
+            {
+                auto [line, x] = getVisualPosition(mCurrentRow, mSelection);
+                if (line + 1 < (int32_t)getWrap(mCurrentRow).size())
+                {
+                    mSelection = getVisualColumn(mCurrentRow, line + 1, x);
+                }
+                else if ((size_t)mCurrentRow + 1 < mRows.size())
+                {
+                    mCurrentRow++;
+                    mSelection = getVisualColumn(mCurrentRow, 0, x);
+                }
+                invalidate();
+                return;
+            }
             mCurrentRow = std::min((int32_t)mRows.size() - 1, mCurrentRow + 1);
-            mSelection = std::min((int32_t)mRows.at(mCurrentRow).size(), mSelection);
-            mRerender = true;
+            mSelection = std::min((int32_t)mRows[mCurrentRow].size(), mSelection);
+            invalidate();
             return;
         }
-        virtual constexpr void doTab()
+        virtual void doTab() override
         {
             if (!mActive) { return; }
-            mRows.at(mCurrentRow).insert(mSelection, "    ");
+            mRows.insertText(mCurrentRow, mSelection, "    ");
             mSelection += 4;
-            mRerender = true;
+            rowChanged(mCurrentRow);
+            invalidate();
             return;
         }
-        virtual constexpr void doBackspace()
+        virtual void doBackspace() override
         {
             if (!mActive) { return; }
             if (mSelection != 0)
             {
-                mRows.at(mCurrentRow).erase(mSelection - 1, 1);
+                mRows.eraseText(mCurrentRow, mSelection - 1, 1);
                 mSelection--;
-                mRerender = true;
+                rowChanged(mCurrentRow);
+                invalidate();
                 return;
             }
             if (mCurrentRow != 0)
             {
-                mSelection = mRows.at(mCurrentRow - 1).size();
-                mRows.at(mCurrentRow - 1).append(mRows.at(mCurrentRow));
-                mRows.erase(mRows.begin() + mCurrentRow);
+                mSelection = mRows[mCurrentRow - 1].size();
+                mRows.joinRow(mCurrentRow - 1);
+                rowErased(mCurrentRow);
                 mCurrentRow--;
-                mRerender = true;
+                rowChanged(mCurrentRow);
+                invalidate();
                 return;
             }
 
             return;
         }
-        virtual constexpr void doReturn()
+        virtual void doReturn() override
         {
             if (!mActive) { return; }
             if (mRows.size() + 1 > (size_t)mMaxRows) { return; }
-            mRows.insert(mRows.begin() + mCurrentRow + 1, std::string{ mRows.at(mCurrentRow).begin() + mSelection, mRows.at(mCurrentRow).end() });
-            mRows.at(mCurrentRow).erase(mSelection);
+            mRows.splitRow(mCurrentRow, mSelection);
+            rowChanged(mCurrentRow);
+            rowInserted(mCurrentRow + 1);
 
             mCurrentRow++;
             mSelection = 0;
-            mRerender = true;
+            invalidate();
             return;
         }
 
-        //Getters
-        constexpr const SDL_Rect& getRegion() const noexcept { return mRegion; }
-        constexpr std::string getString() const
+        ///Clicking moves the cursor to the clicked character
+        virtual void doMouseButton(SDL_MouseButtonEvent& event, int32_t x, int32_t y) noexcept override
         {
-            std::string str;
-            for (const auto& row : mRows)
+            if (!mActive || event.button != SDL_BUTTON_LEFT) { return; }
+            if (x < mTextRegion.x || x >= mTextRegion.x + mTextRegion.w || y < mTextRegion.y || y >= mTextRegion.y + mTextRegion.h) { return; }
+
+            if (mWordWrap)
             {
-                str.append(row);
-                str += '\n';
+                //Walks down the visual lines from the top of the view
+                int32_t row = mScrollY;
+                int32_t line = mScrollLine;
+                for (auto i = mTextRegion.y; i < y; i++)
+                {
+                    if (line + 1 < (int32_t)getWrap(row).size())
+                    {
+                        line++;
+                    }
+                    else if ((size_t)row + 1 < mRows.size())
+                    {
+                        row++;
+                        line = 0;
+                    }
+                }
+                mCurrentRow = row;
+                mSelection = getVisualColumn(row, line, x - mTextRegion.x);
+                invalidate();
+                return;
             }
 
-            //Removes last newline char
-            if (str.size() > 0)
+            mCurrentRow = std::min((int32_t)mRows.size() - 1, mScrollY + (y - mTextRegion.y));
+            mSelection = std::min((int32_t)mRows[mCurrentRow].size(), mScrollX + (x - mTextRegion.x));
+            invalidate();
+            return;
+        }
+
+        ///Starts searching for query and highlights the matches, an empty query stops searching
+        ///
+        ///The visible rows are searched straight away, the rest over the following frames
+        void find(std::string_view query)
+        {
+            if (query.empty())
             {
-                str.pop_back();
+                mSearch.clear();
+                invalidate();
+                return;
             }
 
+            mSearch.start(query, 0, mRows.size(), mScrollY);
+            mSearch.step([this](uint64_t row) { return mRows[row]; }, SEARCH_BUDGET);
+            invalidate();
+
+            return;
+        }
+        ///Moves the cursor to the next match found so far, wrapping to the first
+        ///
+        ///@return false if no match has been found
+        bool findNext()
+        {
+            return moveToMatch(mSearch.findAfter(mCurrentRow, mSelection));
+        }
+        ///Moves the cursor to the previous match found so far, wrapping to the last
+        ///
+        ///@return false if no match has been found
+        bool findPrev()
+        {
+            return moveToMatch(mSearch.findBefore(mCurrentRow, mSelection));
+        }
+
+        //Getters
+        virtual constexpr const SDL_Rect& getRegion() const noexcept override { return mRegion; }
+        virtual constexpr bool isOpaque() const noexcept override { return true; }
+        std::string getString() const
+        {
+            std::string str;
+            str.reserve(mRows.getByteSize() + mRows.size());
+            mRows.forEachRow([&](std::string_view row)
+                    {
+                        str.append(row);
+                        str += '\n';
+                    });
+
+            //Removes last newline char
+            str.pop_back();
+
             return str;
         }
+        ///Writes the text to os a row at a time, without building it as one string
+        void writeString(std::ostream& os) const
+        {
+            bool first = true;
+            mRows.forEachRow([&](std::string_view row)
+                    {
+                        if (!first)
+                        {
+                            os << '\n';
+                        }
+                        os << row;
+                        first = false;
+                    });
+
+            return;
+        }
         constexpr bool getWordWrap() const noexcept { return mWordWrap; }
         constexpr int32_t getMaxRows() const noexcept { return mMaxRows; }
+        constexpr const TextSearch& getSearch() const noexcept { return mSearch; }
+        constexpr const TextRows& getRows() const noexcept { return mRows; }
 
         //Setters
-        constexpr void setRegion(const SDL_Rect& region) 
+        void setRegion(const SDL_Rect& region)
         {
             if (region.w <= 2 || region.h <= 2)
             {
@@ -151,35 +293,34 @@ namespace conslr::widgets
 
             mRegion = region;
             mTextRegion = { mRegion.x + 1, mRegion.y + 1, mRegion.w - 2, mRegion.h - 2 };
+            mScrollLine = 0;
 
-            mRerender = true;
+            invalidate();
             return;
         }
-        constexpr void setString(const std::string& text)
+        void setString(std::string text)
         {
-            mRows.clear();
+            mRows.assign(std::move(text));
             mCurrentRow = 0;
             mSelection = 0;
+            mScrollY = 0;
+            mScrollLine = 0;
+            mWrapCache.clear();
 
-            std::string str;
-            for (const auto& c : text)
-            {
-                if (c == '\n')
-                {
-                    mRows.emplace_back(str);
-                    str.clear();
-                    continue;
-                }
-
-                str += c;
-            }
-            mRows.emplace_back(str);
+            textChanged();
+            invalidate();
+            return;
+        }
+        void setWordWrap(bool val) noexcept
+        {
+            mWordWrap = val;
+            mScrollX = 0;
+            mScrollLine = 0;
+            invalidate();
 
-            mRerender = true;
             return;
         }
-        constexpr void setWordWrap(bool val) noexcept { mWordWrap = val; mRerender = true; }
-        constexpr void setMaxRows(int32_t max)
+        void setMaxRows(int32_t max)
         {
             mMaxRows = max;
             if (mMaxRows == -1)
@@ -190,23 +331,36 @@ namespace conslr::widgets
             if ((size_t)mMaxRows < mRows.size())
             {
                 //Removes excess rows
-                mRows = { mRows.begin(), mRows.begin() + mMaxRows };
+                mRows.truncate(mMaxRows);
+                mCurrentRow = std::min(mCurrentRow, (int32_t)mRows.size() - 1);
+                mSelection = std::min((int32_t)mRows[mCurrentRow].size(), mSelection);
+                mWrapCache.clear();
+                textChanged();
             }
 
-            mRerender = true;
+            invalidate();
             return;
         }
 
     protected:
-        constexpr TextInput(int32_t id, int32_t priority) noexcept :
+        TextInput(int32_t id, int32_t priority) :
             IWidget{ id, priority },
             mRegion{ 0, 0, 0, 0 }, mTextRegion{ 0, 0, 0, 0, },
             mMaxRows{ -1 },
             mCurrentRow{ 0 }, mSelection{ 0 },
             mWordWrap{ false },
-            mScrollX{ 0 }, mScrollY{ 0 }
+            mScrollX{ 0 }, mScrollY{ 0 }, mScrollLine{ 0 },
+            mWrapCacheFirst{ 0 }, mWrapWidth{ 0 }
+        {}
+
+        ///Continues the search
+        virtual void update() override
         {
-            mRows.emplace_back();
+            if (!mSearch.isDone())
+            {
+                mSearch.step([this](uint64_t row) { return mRows[row]; }, SEARCH_BUDGET);
+                invalidate();
+            }
 
             return;
         }
@@ -234,6 +388,96 @@ namespace conslr::widgets
             if (mWordWrap)
             {
                 //Word wrap rendering
+                mScrollX = 0;
+                mScrollY = std::min(mScrollY, (int32_t)mRows.size() - 1);
+                mScrollLine = std::min(mScrollLine, (int32_t)getWrap(mScrollY).size() - 1);
+
+                //Ensures that the cursor's visual line is within the text region
+                auto [cursorLine, cursorX] = getVisualPosition(mCurrentRow, mSelection);
+                if (mCurrentRow < mScrollY || (mCurrentRow == mScrollY && cursorLine < mScrollLine))
+                {
+                    mScrollY = mCurrentRow;
+                    mScrollLine = cursorLine;
+                }
+                else if (mCurrentRow - mScrollY >= mTextRegion.h)
+                {
+                    //Too far to count the lines in between, so the view is placed above the cursor instead
+                    mScrollY = mCurrentRow;
+                    mScrollLine = cursorLine;
+                    scrollVisualLines(-(mTextRegion.h - 1));
+                }
+                else
+                {
+                    int32_t offset = cursorLine - mScrollLine;
+                    for (auto row = mScrollY; row < mCurrentRow; row++)
+                    {
+                        offset += getWrap(row).size();
+                    }
+                    if (offset >= mTextRegion.h)
+                    {
+                        scrollVisualLines(offset - mTextRegion.h + 1);
+                    }
+                }
+
+                //Y of the first visual line of each shown row, the first row may start above the region
+                std::vector<int32_t> rowY;
+                int32_t row = mScrollY;
+                int32_t line = mScrollLine;
+                for (auto i = 0; i < mTextRegion.h && (size_t)row < mRows.size(); i++)
+                {
+                    const auto& starts = getWrap(row);
+                    if (line == 0 || i == 0)
+                    {
+                        rowY.push_back(i - line);
+                    }
+
+                    std::string_view text = mRows[row];
+                    int32_t end = line + 1 < (int32_t)starts.size() ? starts[line + 1] : (int32_t)text.size();
+                    screen.renderText(mTextRegion.x, mTextRegion.y + i, mTextRegion.w, text.substr(starts[line], end - starts[line]));
+
+                    if (++line == (int32_t)starts.size())
+                    {
+                        row++;
+                        line = 0;
+                    }
+                }
+
+                //Search matches
+                int32_t matchSize = mSearch.getQuery().size();
+                mSearch.forEachInLines(mScrollY, mScrollY + rowY.size() - 1, [&](const TextSearch::Match& match)
+                        {
+                            for (auto column = match.column; column < match.column + matchSize; column++)
+                            {
+                                auto [matchLine, matchX] = getVisualPosition(match.line, column);
+                                int32_t y = rowY[match.line - mScrollY] + matchLine;
+                                if (y >= 0 && y < mTextRegion.h)
+                                {
+                                    screen.setCellBackground(mTextRegion.x + matchX, mTextRegion.y + y, mTheme->highlight);
+                                }
+                            }
+                        });
+
+                if (mActive && (size_t)(mCurrentRow - mScrollY) < rowY.size())
+                {
+                    screen.setCellBackground(mTextRegion.x + cursorX, mTextRegion.y + rowY[mCurrentRow - mScrollY] + cursorLine, mTheme->selection);
+                }
+
+                //Scrollbar, by rows as visual lines are only known near the view
+                if (mRows.size() > (size_t)mTextRegion.h)
+                {
+                    double visiblePercent = (double)mTextRegion.h / (double)mRows.size();
+                    double percentDown = (double)mScrollY / (double)mRows.size();
+
+                    int32_t scrollbarOffset = percentDown * mTextRegion.h;
+                    int32_t scrollbarHeight = visiblePercent * mTextRegion.h;
+
+                    screen.fillRectCharacter({
+                            mRegion.x,
+                            mTextRegion.y + scrollbarOffset,
+                            1,
+                            std::min(scrollbarHeight + 1, mTextRegion.h - scrollbarOffset)
+                            }, mTheme->scrollbarCharacter);
+                }
             } else
             {
                 //No word wrap rendering
@@ -269,12 +513,12 @@ namespace conslr::widgets
 
                 for (auto i = 0; i < mTextRegion.h; i++)
                 {
-                    if ((size_t)i >= mRows.size())
+                    if ((size_t)(i + mScrollY) >= mRows.size())
                     {
                         break;
                     }
 
-                    const std::string& row = mRows.at(i + mScrollY);
+                    std::string_view row = mRows[i + mScrollY];
                     if (row.size() <= (size_t)mScrollX)
                     {
                         continue;
@@ -283,6 +527,18 @@ namespace conslr::widgets
                     screen.renderText(mTextRegion.x, mTextRegion.y + i, mTextRegion.w, row.substr(mScrollX));
                 }
 
+                //Search matches
+                int32_t matchSize = mSearch.getQuery().size();
+                mSearch.forEachInLines(mScrollY, mScrollY + mTextRegion.h - 1, [&](const TextSearch::Match& match)
+                        {
+                            int32_t start = std::max(match.column, mScrollX);
+                            int32_t end = std::min(match.column + matchSize, mScrollX + mTextRegion.w);
+                            for (auto x = start; x < end; x++)
+                            {
+                                screen.setCellBackground(mTextRegion.x + x - mScrollX, mTextRegion.y + (int32_t)match.line - mScrollY, mTheme->highlight);
+                            }
+                        });
+
                 if (mActive)
                 {
                     screen.setCellBackground(cursorX, cursorY, mTheme->selection);
@@ -306,12 +562,8 @@ namespace conslr::widgets
                             
                 }
 
-                //Finds size of longest string
-                int32_t maxWidth = std::max_element(mRows.begin(), mRows.end(),
-                        [](const std::string& str1, const std::string& str2)
-                        {
-                            return str1.size() < str2.size();
-                        })->size();
+                //Size of the longest row
+                int32_t maxWidth = mRows.getMaxWidth();
 
                 if (maxWidth > mTextRegion.w)
                 {
@@ -334,15 +586,201 @@ namespace conslr::widgets
             return;
         }
 
+        ///@return Start of each visual line of row when word wrapping, valid until the next call
+        const std::vector<int32_t>& getWrap(size_t row)
+        {
+            if (mWrapWidth != mTextRegion.w)
+            {
+                mWrapCache.clear();
+                mWrapWidth = mTextRegion.w;
+            }
+
+            //The cache covers a run of rows, it grows by one row at either end and starts over anywhere else
+            if (mWrapCache.empty() || row + 1 < mWrapCacheFirst || row > mWrapCacheFirst + mWrapCache.size() || mWrapCache.size() >= WRAP_CACHE_ROWS)
+            {
+                mWrapCache.clear();
+                mWrapCacheFirst = row;
+            }
+            if (row + 1 == mWrapCacheFirst)
+            {
+                mWrapCache.emplace(mWrapCache.begin());
+                mWrapCacheFirst--;
+            }
+            else if (row == mWrapCacheFirst + mWrapCache.size())
+            {
+                mWrapCache.emplace_back();
+            }
+
+            auto& starts = mWrapCache[row - mWrapCacheFirst];
+            if (starts.empty())
+            {
+                layoutRow(mRows[row], std::max(mTextRegion.w, 1), starts);
+            }
+
+            return starts;
+        }
+
+        ///Breaks text into visual lines at the last space that fits, or at the width if there is none
+        ///
+        ///The last visual line is kept shorter than width so the cursor fits after it
+        static void layoutRow(std::string_view text, int32_t width, std::vector<int32_t>& starts)
+        {
+            starts.push_back(0);
+
+            int32_t start = 0;
+            while ((int32_t)text.size() - start >= width)
+            {
+                int32_t next = start + width;
+                for (auto i = start + width; i > start; i--)
+                {
+                    if (text[i - 1] == ' ')
+                    {
+                        next = i;
+                        break;
+                    }
+                }
+
+                starts.push_back(next);
+                start = next;
+            }
+
+            return;
+        }
+
+        ///@return Visual line and x of column in row
+        std::pair<int32_t, int32_t> getVisualPosition(size_t row, int32_t column)
+        {
+            const auto& starts = getWrap(row);
+            int32_t line = (int32_t)(std::upper_bound(starts.begin(), starts.end(), column) - starts.begin()) - 1;
+
+            return { line, column - starts[line] };
+        }
+        ///@return Column in row closest to x on a visual line
+        int32_t getVisualColumn(size_t row, int32_t line, int32_t x)
+        {
+            const auto& starts = getWrap(row);
+            int32_t end = line + 1 < (int32_t)starts.size() ? starts[line + 1] - 1 : (int32_t)mRows[row].size();
+
+            return std::min(starts[line] + x, end);
+        }
+
+        ///Moves the top of the view by amount visual lines
+        void scrollVisualLines(int32_t amount)
+        {
+            for (; amount > 0; amount--)
+            {
+                if (mScrollLine + 1 < (int32_t)getWrap(mScrollY).size())
+                {
+                    mScrollLine++;
+                }
+                else if ((size_t)mScrollY + 1 < mRows.size())
+                {
+                    mScrollY++;
+                    mScrollLine = 0;
+                }
+            }
+            for (; amount < 0; amount++)
+            {
+                if (mScrollLine != 0)
+                {
+                    mScrollLine--;
+                }
+                else if (mScrollY != 0)
+                {
+                    mScrollY--;
+                    mScrollLine = (int32_t)getWrap(mScrollY).size() - 1;
+                }
+            }
+
+            return;
+        }
+
+        ///Lays row out again the next time it is shown and searches it again
+        void rowChanged(size_t row)
+        {
+            if (row >= mWrapCacheFirst && row < mWrapCacheFirst + mWrapCache.size())
+            {
+                mWrapCache[row - mWrapCacheFirst].clear();
+            }
+            mSearch.lineChanged(row, mRows[row]);
+
+            return;
+        }
+        ///Shifts the cached rows and matches after row was inserted
+        void rowInserted(size_t row)
+        {
+            mSearch.linesInserted(row, 1);
+            mSearch.lineChanged(row, mRows[row]);
+
+            if (row < mWrapCacheFirst)
+            {
+                mWrapCacheFirst++;
+            }
+            else if (row <= mWrapCacheFirst + mWrapCache.size())
+            {
+                mWrapCache.emplace(mWrapCache.begin() + (row - mWrapCacheFirst));
+            }
+
+            return;
+        }
+        ///Shifts the cached rows and matches after row was erased
+        void rowErased(size_t row)
+        {
+            mSearch.linesErased(row, 1);
+
+            if (row < mWrapCacheFirst)
+            {
+                mWrapCacheFirst--;
+            }
+            else if (row < mWrapCacheFirst + mWrapCache.size())
+            {
+                mWrapCache.erase(mWrapCache.begin() + (row - mWrapCacheFirst));
+            }
+
+            return;
+        }
+
+        ///Restarts the search after all of the text has been replaced
+        void textChanged()
+        {
+            if (!mSearch.getQuery().empty())
+            {
+                std::string query = mSearch.getQuery();
+                mSearch.start(query, 0, mRows.size(), mScrollY);
+            }
+
+            return;
+        }
+
+        bool moveToMatch(size_t index)
+        {
+            if (index == TextSearch::npos)
+            {
+                return false;
+            }
+
+            mCurrentRow = (int32_t)mSearch[index].line;
+            mSelection = mSearch[index].column;
+            invalidate();
+
+            return true;
+        }
+
         SDL_Rect mRegion;
         SDL_Rect mTextRegion;
-        std::vector<std::string> mRows;
+        TextRows mRows;
         int32_t mMaxRows; //!<Negative values indicate infinite rows
         int32_t mCurrentRow;
         int32_t mSelection;
         bool mWordWrap;
         int32_t mScrollX;
         int32_t mScrollY;
+        int32_t mScrollLine; //!<First shown visual line of row mScrollY when word wrapping
+        TextSearch mSearch;
+
+        std::vector<std::vector<int32_t>> mWrapCache; //!<Start of each visual line of the rows from mWrapCacheFirst on, empty until laid out
+        size_t mWrapCacheFirst;
+        int32_t mWrapWidth; //!<Width mWrapCache was laid out at
     };
 
     inline std::pair<std::string, int32_t> constructTextInput(WidgetManager& wm, const WidgetParameterMap& params)
@@ -435,6 +873,22 @@ namespace conslr::widgets
             ptr->setMaxRows(std::stoi(params.at("maxrows")));
         }
 
+        if (params.contains("wordwrap"))
+        {
+            if (params.at("wordwrap") == "true")
+            {
+                ptr->setWordWrap(true);
+            }
+            else if (params.at("wordwrap") == "false")
+            {
+                ptr->setWordWrap(false);
+            }
+            else
+            {
+                throw std::invalid_argument("Param wordwrap must be \"true\" or \"false\"");
+            }
+        }
+
         if (params.contains("name"))
         {
             return { params.at("name"), ptr->getId() };
@@ -0,0 +1,192 @@
+///
+///@file conslr/wraplayout.hpp
+///@brief Defines WrapLayout, cached line breaks for wrapped text
+///
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "conslr/taggedstring.hpp"
+
+namespace conslr
+{
+    ///
+    ///Splits text into rows at newlines and at the last space that fits in the width
+    ///
+    ///Rows are cached by text revision and width, so rerendering unchanged text does no layout work
+    ///Words longer than the width, or all text when word wrap is off, are broken at the width
+    ///
+    class WrapLayout
+    {
+    public:
+        ///Characters of one row, the space or newline a row was broken at is not part of either row
+        struct Row
+        {
+            int32_t start;
+            int32_t length;
+        };
+
+        ///Lays out text, reusing the cached rows if revision and width are unchanged
+        ///
+        ///@param text Text to lay out
+        ///@param revision Revision of the text, must change whenever the text changes
+        ///@param width Width in characters to wrap at
+        ///@param wordWrap Break rows at spaces, otherwise rows are broken at the width
+        ///@return Rows of the text
+        template<typename CharT>
+        const std::vector<Row>& update(std::span<const CharT> text, uint64_t revision, int32_t width, bool wordWrap)
+        {
+            if (mLaidOut && revision == mRevision && width == mWidth && wordWrap == mWordWrap)
+            {
+                return mRows;
+            }
+
+            int32_t from = 0;
+            if (mLaidOut && mAppendOnly && width == mWidth && wordWrap == mWordWrap)
+            {
+                from = mRestart;
+            }
+            else
+            {
+                mRows.clear();
+            }
+
+            layout(text, from, width, wordWrap);
+
+            mLaidOut = true;
+            mAppendOnly = false;
+            mRevision = revision;
+            mWidth = width;
+            mWordWrap = wordWrap;
+
+            return mRows;
+        }
+
+        ///Tells the layout text is about to be appended, so the next update only lays out the last row onwards
+        ///
+        ///@param size Size of the text before appending
+        ///@param revision Revision of the text before appending
+        constexpr void textAppended(int32_t size, uint64_t revision) noexcept
+        {
+            if (!mLaidOut || (revision != mRevision && !mAppendOnly))
+            {
+                mLaidOut = false;
+                return;
+            }
+
+            //Only the rows reaching the old end of the text can change, the +1 covers a row broken at a trailing space
+            while (!mRows.empty() && mRows.back().start + mRows.back().length + 1 >= size)
+            {
+                mRestart = mRows.back().start;
+                mRows.pop_back();
+            }
+            if (mRows.empty())
+            {
+                mRestart = 0;
+            }
+
+            mAppendOnly = true;
+
+            return;
+        }
+
+        [[nodiscard]] constexpr const std::vector<Row>& getRows() const noexcept { return mRows; }
+
+    private:
+        template<typename CharT>
+        static constexpr uint8_t charAt(std::span<const CharT> text, int32_t i) noexcept
+        {
+            if constexpr (std::is_same_v<CharT, TaggedChar>) { return text[i].character; }
+            else { return (uint8_t)text[i]; }
+        }
+
+        template<typename CharT>
+        static int32_t findNewline(std::span<const CharT> text, int32_t from) noexcept
+        {
+            if constexpr (std::is_same_v<CharT, char>)
+            {
+                const char* found = (const char*)std::memchr(text.data() + from, '\n', text.size() - from);
+                return found == nullptr ? (int32_t)text.size() : (int32_t)(found - text.data());
+            }
+            else
+            {
+                for (auto i = from; i < (int32_t)text.size(); i++)
+                {
+                    if (charAt(text, i) == '\n') { return i; }
+                }
+
+                return (int32_t)text.size();
+            }
+        }
+
+        //Rows are broken greedily, so laying out from the start of any row gives the same rows as from the start of the text
+        template<typename CharT>
+        void layout(std::span<const CharT> text, int32_t from, int32_t width, bool wordWrap)
+        {
+            if (width <= 0)
+            {
+                return;
+            }
+
+            int32_t size = (int32_t)text.size();
+            int32_t pos = from;
+            while (true)
+            {
+                int32_t end = findNewline(text, pos);
+                if (pos == end)
+                {
+                    mRows.push_back({ pos, 0 });
+                }
+
+                while (pos < end)
+                {
+                    if (end - pos <= width)
+                    {
+                        mRows.push_back({ pos, end - pos });
+                        pos = end;
+                        break;
+                    }
+
+                    int32_t length = width;
+                    int32_t next = pos + width;
+                    if (wordWrap)
+                    {
+                        for (auto i = pos + width; i > pos; i--)
+                        {
+                            if (charAt(text, i) == ' ')
+                            {
+                                length = i - pos;
+                                next = i + 1;
+                                break;
+                            }
+                        }
+                    }
+
+                    mRows.push_back({ pos, length });
+                    pos = next;
+                }
+
+                if (end >= size)
+                {
+                    break;
+                }
+                pos = end + 1;
+            }
+
+            return;
+        }
+
+        std::vector<Row> mRows;
+
+        bool mLaidOut = false; //!<False until the first update, or when the rows can not be trusted
+        bool mAppendOnly = false; //!<Text was only appended to since the last update, rows before mRestart are still valid
+        int32_t mRestart = 0; //!<Offset of the first row to lay out when mAppendOnly
+        uint64_t mRevision = 0;
+        int32_t mWidth = 0;
+        bool mWordWrap = true;
+    };
+}
@@ -16,9 +16,12 @@ conslr::Console::Console(int32_t cellWidth, int32_t cellHeight, int32_t windowCe
     mCellWidth{ cellWidth }, mCellHeight{ cellHeight },
     mWindowCellWidth{ windowCellWidth }, mWindowCellHeight{ windowCellHeight },
     mWindowWidth{ cellWidth * windowCellWidth }, mWindowHeight{ cellHeight * windowCellHeight },
-    mTheme{ std::make_shared<Theme>() },
+    mTheme{ std::make_shared<Theme>() }, mThemeVersion{ 0 },
     mWindow{ nullptr, SDL_DestroyWindow }, mRenderer{ nullptr, SDL_DestroyRenderer },
+    mEventRouting{ false }, mEventCoalescing{ false },
+    mMouseX{ -1 }, mMouseY{ -1 },
     mCurrentScreen{ -1 },
+    mScreenCaching{ false }, mNextPrerender{ 0 },
     mCurrentFont{ -1 }
 {
     if (!(cellWidth > 0 && cellHeight > 0 && windowCellWidth > 0 && windowCellHeight > 0))
@@ -29,18 +32,6 @@ conslr::Console::Console(int32_t cellWidth, int32_t cellHeight, int32_t windowCe
                 ", windowCellHeight: " + std::to_string(windowCellHeight));
     }
 
-    for (auto i = 0; i < MAX_SCREENS; i++)
-    {
-        mFreeScreens.push(i);
-        mScreens.at(i).reset(nullptr);
-    }
-
-    for (auto i = 0; i < MAX_FONTS; i++)
-    {
-        mFreeFonts.push(i);
-        mFonts.at(i).reset(nullptr);
-    }
-
     if (!SDL_WasInit(SDL_INIT_VIDEO))
     {
         if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0)
@@ -61,6 +52,8 @@ conslr::Console::Console(int32_t cellWidth, int32_t cellHeight, int32_t windowCe
         throw std::runtime_error(std::string("Failed to create renderer: ") + SDL_GetError());
     }
 
+    buildKeyActions();
+
     return;
 }
 
@@ -73,6 +66,12 @@ conslr::Console::~Console()
 
 bool conslr::Console::doEvent(SDL_Event& event)
 {
+    //Held back input goes first, so keys that change focus or screens see it applied
+    if (mEventCoalescing && !isCoalesced(event))
+    {
+        flushEvents();
+    }
+
     if (event.type == SDL_QUIT)
     {
         destroy();
@@ -94,11 +93,318 @@ bool conslr::Console::doEvent(SDL_Event& event)
         }
     }
 
+    if (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEWHEEL)
+    {
+        doMouseEvent(event);
+    }
+
+    if (mEventRouting && (event.type == SDL_KEYDOWN || event.type == SDL_TEXTINPUT))
+    {
+        doRoutedEvent(event);
+    }
+
     return true;
 }
 
+void conslr::Console::doMouseEvent(SDL_Event& event)
+{
+    //Window ids are at the same offset for all mouse events
+    if (event.motion.windowID != SDL_GetWindowID(mWindow.get()))
+    {
+        return;
+    }
+
+    if (event.type == SDL_MOUSEMOTION)
+    {
+        mMouseX = event.motion.x / mCellWidth;
+        mMouseY = event.motion.y / mCellHeight;
+    }
+    else if (event.type == SDL_MOUSEBUTTONDOWN)
+    {
+        mMouseX = event.button.x / mCellWidth;
+        mMouseY = event.button.y / mCellHeight;
+    }
+
+    if (mCurrentScreen < 0 || mScreens.at(mCurrentScreen) == nullptr)
+    {
+        return;
+    }
+    auto& scr = *mScreens.at(mCurrentScreen);
+
+    int32_t id = scr.getWidgetAt(mMouseX, mMouseY);
+
+    if (mEventCoalescing)
+    {
+        if (event.type == SDL_MOUSEMOTION)
+        {
+            //Only the last position matters, the target is looked up when flushed
+            if (mPending.kind != PendingKind::Motion) { flushEvents(); }
+            mPending.kind = PendingKind::Motion;
+            mPending.screen = mCurrentScreen;
+            return;
+        }
+
+        if (event.type == SDL_MOUSEWHEEL && id >= 0)
+        {
+            if (mPending.kind == PendingKind::Wheel && mPending.screen == mCurrentScreen && mPending.target == id)
+            {
+                mPending.wheel.x += event.wheel.x;
+                mPending.wheel.y += event.wheel.y;
+                return;
+            }
+
+            flushEvents();
+            mPending.kind = PendingKind::Wheel;
+            mPending.screen = mCurrentScreen;
+            mPending.target = id;
+            mPending.wheel = event.wheel;
+            return;
+        }
+
+        flushEvents();
+    }
+
+    if (id < 0)
+    {
+        return;
+    }
+    const auto& interfaces = scr.mWidgetManager.getInterfaces(id);
+
+    switch (event.type)
+    {
+    case SDL_MOUSEMOTION:
+        if (interfaces.mouseInput) { interfaces.mouseInput->doMouseMotion(mMouseX, mMouseY); }
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+        if (interfaces.mouseInput) { interfaces.mouseInput->doMouseButton(event.button, mMouseX, mMouseY); }
+        break;
+    case SDL_MOUSEWHEEL:
+        doMouseWheel(interfaces, event.wheel);
+        break;
+    default:
+        break;
+    }
+
+    return;
+}
+
+void conslr::Console::doMouseWheel(const WidgetManager::WidgetInterfaces& interfaces, SDL_MouseWheelEvent& wheel)
+{
+    if (interfaces.mouseInput && interfaces.mouseInput->doMouseWheel(wheel, mMouseX, mMouseY))
+    {
+        return;
+    }
+
+    if (interfaces.scrollable)
+    {
+        //Positive y is away from the user
+        interfaces.scrollable->scrollBy(-wheel.y);
+    }
+
+    return;
+}
+
+void conslr::Console::doRoutedEvent(SDL_Event& event)
+{
+    //Window ids are at the same offset for key and text input events
+    if (event.key.windowID != SDL_GetWindowID(mWindow.get()))
+    {
+        return;
+    }
+
+    if (mCurrentScreen < 0 || mScreens.at(mCurrentScreen) == nullptr)
+    {
+        return;
+    }
+    auto& wm = mScreens.at(mCurrentScreen)->mWidgetManager;
+
+    int32_t focused = wm.getFocused();
+    const auto& interfaces = wm.getInterfaces(focused);
+
+    KeyAction action = KeyAction::None;
+    if (event.type == SDL_KEYDOWN)
+    {
+        action = findKeyAction(event.key);
+        if (action == KeyAction::None)
+        {
+            return;
+        }
+    }
+
+    if (mEventCoalescing)
+    {
+        //Text for an inactive widget is dropped by doTextInput, so only text for an active one is held back
+        if (event.type == SDL_TEXTINPUT && interfaces.textInput && interfaces.widget->getActive())
+        {
+            if (!(mPending.kind == PendingKind::Text && mPending.screen == mCurrentScreen && mPending.target == focused))
+            {
+                flushEvents();
+                mPending.kind = PendingKind::Text;
+                mPending.screen = mCurrentScreen;
+                mPending.target = focused;
+            }
+
+            mPending.text += event.text.text;
+            return;
+        }
+
+        if ((action == KeyAction::ScrollUp || action == KeyAction::ScrollDown) && interfaces.scrollable && !interfaces.textInput)
+        {
+            if (!(mPending.kind == PendingKind::Scroll && mPending.screen == mCurrentScreen && mPending.target == focused))
+            {
+                flushEvents();
+                mPending.kind = PendingKind::Scroll;
+                mPending.screen = mCurrentScreen;
+                mPending.target = focused;
+            }
+
+            mPending.scroll += action == KeyAction::ScrollUp ? -1 : 1;
+            return;
+        }
+
+        flushEvents();
+    }
+
+    if (event.type == SDL_TEXTINPUT)
+    {
+        if (interfaces.textInput) { interfaces.textInput->doTextInput(event.text); }
+        return;
+    }
+
+    if (action == KeyAction::Tab && !interfaces.textInput)
+    {
+        wm.focusNext();
+        return;
+    }
+
+    if (interfaces.textInput)
+    {
+        auto* input = interfaces.textInput;
+        switch (action)
+        {
+        case KeyAction::ScrollUp: input->doKeyUp(); break;
+        case KeyAction::ScrollDown: input->doKeyDown(); break;
+        case KeyAction::ScrollLeft: input->doKeyLeft(); break;
+        case KeyAction::ScrollRight: input->doKeyRight(); break;
+        case KeyAction::Tab: input->doTab(); break;
+        case KeyAction::Enter: input->doReturn(); break;
+        case KeyAction::Backspace: input->doBackspace(); break;
+        default: break;
+        }
+    }
+    else if (interfaces.scrollable)
+    {
+        switch (action)
+        {
+        case KeyAction::ScrollUp: interfaces.scrollable->scrollUp(); break;
+        case KeyAction::ScrollDown: interfaces.scrollable->scrollDown(); break;
+        default: break;
+        }
+    }
+
+    return;
+}
+
+void conslr::Console::flushEvents()
+{
+    PendingInput pending = std::move(mPending);
+    mPending = {};
+
+    if (pending.kind == PendingKind::None)
+    {
+        return;
+    }
+
+    //The screen may have been destroyed since the input was queued
+    if (!(pending.screen >= 0 && (size_t)pending.screen < mScreens.size()) || mScreens.at(pending.screen) == nullptr)
+    {
+        return;
+    }
+    auto& scr = *mScreens.at(pending.screen);
+
+    int32_t target = pending.kind == PendingKind::Motion ? scr.getWidgetAt(mMouseX, mMouseY) : pending.target;
+    if (target < 0)
+    {
+        return;
+    }
+    const auto& interfaces = scr.mWidgetManager.getInterfaces(target);
+
+    switch (pending.kind)
+    {
+    case PendingKind::Motion:
+        if (interfaces.mouseInput) { interfaces.mouseInput->doMouseMotion(mMouseX, mMouseY); }
+        break;
+    case PendingKind::Wheel:
+        doMouseWheel(interfaces, pending.wheel);
+        break;
+    case PendingKind::Scroll:
+        if (interfaces.scrollable) { interfaces.scrollable->scrollBy(pending.scroll); }
+        break;
+    case PendingKind::Text:
+        if (interfaces.textInput) { interfaces.textInput->insertText(pending.text); }
+        break;
+    default:
+        break;
+    }
+
+    return;
+}
+
+conslr::KeyAction conslr::Console::findKeyAction(const SDL_KeyboardEvent& key) const noexcept
+{
+    auto it = mKeyActions.find(((uint32_t)key.keysym.scancode << 16) | (key.keysym.mod & ~LOCK_MODIFIERS));
+
+    return it == mKeyActions.end() ? KeyAction::None : it->second;
+}
+
+bool conslr::Console::isCoalesced(const SDL_Event& event) const noexcept
+{
+    switch (event.type)
+    {
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEWHEEL:
+        return true;
+    case SDL_TEXTINPUT:
+        return mEventRouting;
+    case SDL_KEYDOWN:
+    {
+        KeyAction action = findKeyAction(event.key);
+        return mEventRouting && (action == KeyAction::ScrollUp || action == KeyAction::ScrollDown);
+    }
+    default:
+        return false;
+    }
+}
+
+void conslr::Console::buildKeyActions()
+{
+    auto key = [](const KeyPair& pair) -> uint32_t { return ((uint32_t)pair.scancode << 16) | (pair.mod & ~LOCK_MODIFIERS); };
+
+    mKeyActions.clear();
+    mKeyActions[key(mKeyMap.scrollUp)] = KeyAction::ScrollUp;
+    mKeyActions[key(mKeyMap.scrollDown)] = KeyAction::ScrollDown;
+    mKeyActions[key(mKeyMap.scrollLeft)] = KeyAction::ScrollLeft;
+    mKeyActions[key(mKeyMap.scrollRight)] = KeyAction::ScrollRight;
+    mKeyActions[key(mKeyMap.tab)] = KeyAction::Tab;
+    mKeyActions[key(mKeyMap.enter)] = KeyAction::Enter;
+    mKeyActions[key(mKeyMap.backspace)] = KeyAction::Backspace;
+
+    return;
+}
+
 void conslr::Console::render()
 {
+    flushEvents();
+
+    //Every screen is updated so widgets fed from other threads stay bounded when their screen is not shown
+    for (auto& screen : mScreens)
+    {
+        if (screen != nullptr)
+        {
+            screen->mWidgetManager.updateWidgets();
+        }
+    }
+
     SDL_SetRenderDrawColor(mRenderer.get(), 0, 0, 0, 255);
     SDL_RenderClear(mRenderer.get());
 
@@ -114,20 +420,53 @@ void conslr::Console::render()
     }
     auto& scr = *mScreens.at(mCurrentScreen);
 
-    for (auto& ptr : scr.mWidgetManager.getRenderable())
+    bool rendered = updateScreen(scr);
+
+    if (mScreenCaching)
     {
-        if (ptr->mRerender)
+        SDL_Texture* texture = updateScreenCache(mCurrentScreen, rendered);
+        if (texture != nullptr)
         {
-            scr.mRerender = true;
-            break;
+            SDL_RenderCopy(mRenderer.get(), texture, nullptr, nullptr);
+            SDL_RenderPresent(mRenderer.get());
+
+            //Nothing changed on the current screen, use the time to bring a background screen up to date
+            if (!rendered)
+            {
+                prerenderScreen();
+            }
+
+            return;
         }
     }
 
-    if (scr.mRerender)
+    drawCells(scr);
+
+    SDL_RenderPresent(mRenderer.get());
+
+    return;
+}
+
+bool conslr::Console::updateScreen(Screen& scr)
+{
+    if (scr.mWidgetManager.isDirty() || scr.mThemeVersion != mThemeVersion)
     {
-        scr.render();
+        scr.mRerender = true;
+        scr.mThemeVersion = mThemeVersion;
     }
 
+    if (!scr.mRerender)
+    {
+        return false;
+    }
+
+    scr.render();
+
+    return true;
+}
+
+void conslr::Console::drawCells(const Screen& scr)
+{
     const auto& cells = scr.getCells();
     //Ensure size of screen is same as size of console
     assert((cells.size() == (size_t)(mWindowCellWidth * mWindowCellHeight)) && "Size of console and size of screen do not match");
@@ -153,35 +492,96 @@ void conslr::Console::render()
         SDL_RenderCopy(mRenderer.get(), font.mTexture.get(), &src, &rect);
     }
 
-    SDL_RenderPresent(mRenderer.get());
-
     return;
 }
 
-void conslr::Console::destroy()
+//The texture is redrawn when the screen was rendered, or when it was drawn with a different font or cell size
+//Returns nullptr if the renderer cannot render to textures
+SDL_Texture* conslr::Console::updateScreenCache(int32_t index, bool changed)
 {
-    for (auto& scrPtr : mScreens)
+    if (!SDL_RenderTargetSupported(mRenderer.get()))
     {
-        scrPtr.reset(nullptr);
+        return nullptr;
     }
-    mCurrentScreen = -1;
-    mFreeScreens = {};
-    for (auto i = 0; i < MAX_SCREENS; i++)
+
+    if ((size_t)index >= mScreenCaches.size())
     {
-        mFreeScreens.push(i);
+        mScreenCaches.resize(mScreens.size());
     }
+    auto& cache = mScreenCaches.at(index);
 
-    for (auto& fontPtr : mFonts)
+    if (cache.texture == nullptr || cache.width != mWindowWidth || cache.height != mWindowHeight)
     {
-        fontPtr.reset(nullptr);
+        cache.texture.reset(SDL_CreateTexture(mRenderer.get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, mWindowWidth, mWindowHeight));
+        if (cache.texture == nullptr)
+        {
+            return nullptr;
+        }
+
+        cache.width = mWindowWidth;
+        cache.height = mWindowHeight;
+        cache.valid = false;
     }
-    mCurrentFont = -1;
-    mFreeFonts = {};
-    for (auto i = 0; i < MAX_FONTS; i++)
+
+    if (changed || !cache.valid || cache.font != mCurrentFont)
     {
-        mFreeFonts.push(i);
+        SDL_SetRenderTarget(mRenderer.get(), cache.texture.get());
+        SDL_SetRenderDrawColor(mRenderer.get(), 0, 0, 0, 255);
+        SDL_RenderClear(mRenderer.get());
+        drawCells(*mScreens.at(index));
+        SDL_SetRenderTarget(mRenderer.get(), nullptr);
+
+        cache.font = mCurrentFont;
+        cache.valid = true;
+    }
+
+    return cache.texture.get();
+}
+
+//Brings at most one dirty background screen up to date per call, taking turns between screens
+void conslr::Console::prerenderScreen()
+{
+    int32_t count = (int32_t)mScreens.size();
+    for (auto i = 0; i < count; i++)
+    {
+        int32_t index = (mNextPrerender + i) % count;
+        if (index == mCurrentScreen || mScreens.at(index) == nullptr)
+        {
+            continue;
+        }
+
+        bool rendered = updateScreen(*mScreens.at(index));
+
+        bool stale = (size_t)index >= mScreenCaches.size() || !mScreenCaches.at(index).valid ||
+            mScreenCaches.at(index).font != mCurrentFont || mScreenCaches.at(index).width != mWindowWidth || mScreenCaches.at(index).height != mWindowHeight;
+        if (!rendered && !stale)
+        {
+            continue;
+        }
+
+        updateScreenCache(index, rendered);
+        mNextPrerender = index + 1;
+
+        return;
     }
 
+    return;
+}
+
+void conslr::Console::destroy()
+{
+    //Textures belong to the renderer so they go first
+    mScreenCaches.clear();
+
+    mScreens.clear();
+    mRecycledScreens.clear();
+    mFreeScreens.clear();
+    mCurrentScreen = -1;
+
+    mFonts.clear();
+    mFreeFonts.clear();
+    mCurrentFont = -1;
+
     if (mRenderer)
     {
         mRenderer.reset(nullptr);
@@ -198,24 +598,46 @@ void conslr::Console::destroy()
 //Screen functions
 int32_t conslr::Console::createScreen()
 {
-    if (mFreeScreens.empty())
+    std::unique_ptr<Screen> scr = nullptr;
+    while (!mRecycledScreens.empty() && scr == nullptr)
     {
-        throw std::runtime_error("Max screens created, max: " + std::to_string(MAX_SCREENS));
+        scr = std::move(mRecycledScreens.back());
+        mRecycledScreens.pop_back();
+
+        if (scr->getWidth() != mWindowCellWidth || scr->getHeight() != mWindowCellHeight)
+        {
+            scr.reset(nullptr);
+        }
     }
 
-    int32_t index = mFreeScreens.front();
-    mFreeScreens.pop();
+    if (scr == nullptr)
+    {
+        scr.reset(new Screen{ mWindowCellWidth, mWindowCellHeight });
+    }
 
-    mScreens.at(index).reset(new Screen{ mWindowCellWidth, mWindowCellHeight });
+    scr->mWidgetManager.setTheme(mTheme.get());
+    scr->mThemeVersion = mThemeVersion;
+    scr->mRerender = true;
 
-    mScreens.at(index)->mWidgetManager.setTheme(mTheme);
+    int32_t index;
+    if (mFreeScreens.empty())
+    {
+        index = (int32_t)mScreens.size();
+        mScreens.push_back(std::move(scr));
+    }
+    else
+    {
+        index = mFreeScreens.back();
+        mFreeScreens.pop_back();
+        mScreens.at(index) = std::move(scr);
+    }
 
     return index;
 }
 
 void conslr::Console::destroyScreen(int32_t index)
 {
-    if (!(index >= 0 && index < MAX_SCREENS))
+    if (!(index >= 0 && (size_t)index < mScreens.size()))
     {
         throw std::invalid_argument("Screen index is out of bounds, index: " + std::to_string(index));
     }
@@ -224,8 +646,16 @@ void conslr::Console::destroyScreen(int32_t index)
         throw std::runtime_error("Screen at index is already nullptr, index: " + std::to_string(index));
     }
 
-    mScreens.at(index).reset(nullptr);
-    mFreeScreens.push(index);
+    //Held back input refers to the screen by index, which a new screen may reuse
+    flushEvents();
+
+    mScreens.at(index)->reset();
+    mRecycledScreens.push_back(std::move(mScreens.at(index)));
+    if ((size_t)index < mScreenCaches.size())
+    {
+        mScreenCaches.at(index) = {};
+    }
+    mFreeScreens.push_back(index);
 
     return;
 }
@@ -233,11 +663,6 @@ void conslr::Console::destroyScreen(int32_t index)
 //Font functions
 int32_t conslr::Console::createFont(const std::string& file, int32_t charWidth, int32_t charHeight)
 {
-    if (mFreeFonts.empty())
-    {
-        throw std::runtime_error("Max fonts created, max: " + std::to_string(MAX_FONTS));
-    }
-
     if (!IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG))
     {
         throw std::runtime_error("Failed to init SDL2_image");
@@ -259,17 +684,28 @@ int32_t conslr::Console::createFont(const std::string& file, int32_t charWidth,
                 ", charHeight: " + std::to_string(charHeight) + ", height: " + std::to_string(height));
     }
 
-    int32_t index = mFreeFonts.front();
-    mFreeFonts.pop();
-    mFonts.at(index).reset(new Font{ charWidth, charHeight, width / charWidth, height / charHeight });
-    mFonts.at(index)->mTexture.reset(texture);
+    std::unique_ptr<Font> font{ new Font{ charWidth, charHeight, width / charWidth, height / charHeight } };
+    font->mTexture.reset(texture);
+
+    int32_t index;
+    if (mFreeFonts.empty())
+    {
+        index = (int32_t)mFonts.size();
+        mFonts.push_back(std::move(font));
+    }
+    else
+    {
+        index = mFreeFonts.back();
+        mFreeFonts.pop_back();
+        mFonts.at(index) = std::move(font);
+    }
 
     return index;
 }
 
 void conslr::Console::destroyFont(int32_t index)
 {
-    if (!(index >= 0 && index < MAX_FONTS))
+    if (!(index >= 0 && (size_t)index < mFonts.size()))
     {
         throw std::invalid_argument("Font index is out of bounds, index: " + std::to_string(index));
     }
@@ -279,7 +715,16 @@ void conslr::Console::destroyFont(int32_t index)
     }
 
     mFonts.at(index).reset(nullptr);
-    mFreeFonts.push(index);
+    mFreeFonts.push_back(index);
+
+    //The index may be given to a different font
+    for (auto& cache : mScreenCaches)
+    {
+        if (cache.font == index)
+        {
+            cache.valid = false;
+        }
+    }
 
     return;
 }
@@ -481,6 +926,20 @@ conslr::Theme conslr::Console::createTheme(const std::string& file)
             theme.selection = { (uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a };
             continue;
         }
+
+        if (param == "highlight")
+        {
+            int32_t r;
+            int32_t g;
+            int32_t b;
+            int32_t a;
+            
+            std::stringstream colors{value};
+            colors >> r >> g >> b >> a;
+            
+            theme.highlight = { (uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a };
+            continue;
+        }
     }
 
     ifs.close();
@@ -506,21 +965,31 @@ void conslr::Console::resizeCells(int32_t width, int32_t height)
 }
 
 //Setters
-void conslr::Console::setTheme(const Theme& theme) noexcept
+void conslr::Console::setScreenCaching(bool val) noexcept
 {
-    (*mTheme) = theme;
+    mScreenCaching = val;
 
-    for (auto& scr : mScreens)
+    if (!mScreenCaching)
     {
-        if (scr == nullptr)
-        {
-            continue;
-        }
+        mScreenCaches.clear();
+    }
 
-        scr->mWidgetManager.setTheme(mTheme);
+    return;
+}
 
-        scr->mRerender = true;
-    }
+void conslr::Console::setKeyMap(const KeyMapping& keyMap)
+{
+    mKeyMap = keyMap;
+    buildKeyActions();
+
+    return;
+}
+
+void conslr::Console::setTheme(const Theme& theme) noexcept
+{
+    //Every widget points at mTheme, screens notice the new version when they are next updated
+    (*mTheme) = theme;
+    mThemeVersion++;
 
     return;
 }
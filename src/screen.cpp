@@ -1,5 +1,10 @@
 #include "conslr/screen.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
 #include <SDL_events.h>
 
 #include "conslr/taggedstring.hpp"
@@ -7,22 +12,55 @@
 
 conslr::Screen::Screen(int32_t width, int32_t height) :
     mRerender{ true },
+    mThemeVersion{ 0 },
     mWidth{ width }, mHeight{ height },
-    mCells{ (size_t)(mWidth * mHeight), Cell{} }
-{}
+    mCells{ (size_t)(mWidth * mHeight), Cell{} },
+    mCoverage( (size_t)(mWidth * mHeight), 0 ),
+    mGridWidth{ (mWidth + GRID_SIZE - 1) / GRID_SIZE }, mGridHeight{ (mHeight + GRID_SIZE - 1) / GRID_SIZE },
+    mOwners( (size_t)(mWidth * mHeight), -1 )
+{
+    mGrid.resize(mGridWidth * mGridHeight);
+}
+
+void conslr::Screen::reset()
+{
+    mWidgetManager.clear();
+    mWidgetManager.setTheme(nullptr);
+
+    std::fill(mCells.begin(), mCells.end(), Cell{});
+    mDrawList.clear();
+    mFrameStats = {};
+
+    mLayout.clear();
+    for (auto& bucket : mGrid)
+    {
+        bucket.clear();
+    }
+    std::fill(mOwners.begin(), mOwners.end(), -1);
+
+    mRerender = true;
+
+    return;
+}
 
 void conslr::Screen::render()
 {
     clear();
+    cull();
 
-    for (auto& renderablePtr : mWidgetManager.getRenderable())
+    //Draw list is in reverse render order
+    for (auto it = mDrawList.rbegin(); it != mDrawList.rend(); it++)
     {
-        if (renderablePtr->isVisible())
-        {
-            renderablePtr->render(*this);
-        }
-        renderablePtr->mRerender = false;
+        (*it)->render(*this);
+    }
+
+    for (auto renderable : mWidgetManager.mDirty)
+    {
+        renderable->mRerender = false;
     }
+    mWidgetManager.mDirty.clear();
+
+    updateLayout();
 
     mRerender = false;
 
@@ -340,249 +378,372 @@ void conslr::Screen::borderRect(SDL_Rect rect, uint8_t horizontal, uint8_t verti
     return;
 }
 
-void conslr::Screen::renderText(int32_t x, int32_t y, int32_t maxSize, const std::string& str)
+void conslr::Screen::renderText(int32_t x, int32_t y, int32_t maxSize, std::string_view str)
 {
-    if (y < 0 || y >= mHeight) { return; }
+    writeRow<TextColor::None>(x, y, str.data(), std::min(maxSize, (int32_t)str.size()), {});
 
-    int32_t itrSize = std::min(maxSize, (int32_t)str.size());
-    int32_t start = (y * mWidth) + x;
-    for (int i = 0; i < itrSize; i++)
-    {
-        if (x + i < 0 || x + i >= mWidth) { continue; }
+    mRerender = true;
 
-        mCells.at(start + i).character = (unsigned char)str.at(i);
-    }
+    return;
+}
+
+void conslr::Screen::renderMultilineText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str)
+{
+    layoutText<TextColor::None>(x, y, maxWidth, maxHeight, std::span<const char>{ str.data(), str.size() }, {});
 
     mRerender = true;
 
     return;
 }
 
-void conslr::Screen::renderMultilineText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str)
+void conslr::Screen::renderTextColor(int32_t x, int32_t y, int32_t maxSize, std::string_view str, const SDL_Color& color)
 {
-    int32_t i = 0;
-    int32_t j = 0;
-    for (const auto& c : str)
-    {
-        if (c == '\n')
-        {
-            i = 0;
-            j++;
-            continue;
-        }
+    writeRow<TextColor::Foreground>(x, y, str.data(), std::min(maxSize, (int32_t)str.size()), { &color, nullptr, nullptr });
 
-        if (i >= maxWidth)
-        {
-            i = 0;
-            j++;
-        }
-
-        if (j >= maxHeight)
-        {
-            break;
-        }
+    mRerender = true;
 
-        if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+    return;
+}
 
-        mCells.at(((j + y) * mWidth) + x + i).character = (unsigned char)c;
-        i++;
-    }
+void conslr::Screen::renderTextColor(int32_t x, int32_t y, int32_t maxSize, std::string_view str, const SDL_Color& foreground, const SDL_Color& background)
+{
+    writeRow<TextColor::ForegroundBackground>(x, y, str.data(), std::min(maxSize, (int32_t)str.size()), { &foreground, &background, nullptr });
 
     mRerender = true;
 
     return;
 }
 
-void conslr::Screen::renderTextColor(int32_t x, int32_t y, int32_t maxSize, const std::string& str, const SDL_Color& color)
+void conslr::Screen::renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str, const SDL_Color& color)
 {
-    if (y < 0 || y >= mHeight) { return; }
+    layoutText<TextColor::Foreground>(x, y, maxWidth, maxHeight, std::span<const char>{ str.data(), str.size() }, { &color, nullptr, nullptr });
 
-    int32_t itrSize = std::min(maxSize, (int32_t)str.size());
-    int32_t start = (y * mWidth) + x;
-    for (int i = 0; i < itrSize; i++)
-    {
-        if (x + i < 0 || x + i >= mWidth) { continue; }
+    mRerender = true;
 
-        auto& cell = mCells.at(start + i);
+    return;
+}
 
-        cell.character = (unsigned char)str.at(i);
-        cell.foreground = color;
-    }
+void conslr::Screen::renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::string_view str, const SDL_Color& foreground, const SDL_Color& background)
+{
+    layoutText<TextColor::ForegroundBackground>(x, y, maxWidth, maxHeight, std::span<const char>{ str.data(), str.size() }, { &foreground, &background, nullptr });
 
     mRerender = true;
 
     return;
 }
 
-void conslr::Screen::renderTextColor(int32_t x, int32_t y, int32_t maxSize, const std::string& str, const SDL_Color& foreground, const SDL_Color& background)
+void conslr::Screen::renderTextTagged(int32_t x, int32_t y, int32_t maxSize, std::span<const TaggedChar> str, const TagSet& tags)
 {
-    if (y < 0 || y >= mHeight) { return; }
+    writeRow<TextColor::Tagged>(x, y, str.data(), std::min(maxSize, (int32_t)str.size()), { nullptr, nullptr, &tags });
 
-    int32_t itrSize = std::min(maxSize, (int32_t)str.size());
-    int32_t start = (y * mWidth) + x;
-    for (int i = 0; i < itrSize; i++)
-    {
-        if (x + i < 0 || x + i >= mWidth) { continue; }
+    mRerender = true;
 
-        auto& cell = mCells.at(start + i);
+    return;
+}
 
-        cell.character = (unsigned char)str.at(i);
-        cell.foreground = foreground;
-        cell.background = background;
-    }
+void conslr::Screen::renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::span<const TaggedChar> str, const TagSet& tags)
+{
+    layoutText<TextColor::Tagged>(x, y, maxWidth, maxHeight, str, { nullptr, nullptr, &tags });
 
     mRerender = true;
 
     return;
 }
 
-void conslr::Screen::renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& color)
+//Clips the row to the screen once, then writes every remaining character without further checks
+template<conslr::Screen::TextColor Color, typename CharT>
+void conslr::Screen::writeRow(int32_t x, int32_t y, const CharT* str, int32_t count, const TextStyle& style) noexcept
 {
-    int32_t i = 0;
-    int32_t j = 0;
-    for (const auto& c : str)
+    if (y < 0 || y >= mHeight) { return; }
+
+    int32_t first = std::max(0, -x);
+    int32_t last = std::min(count, mWidth - x);
+    if (first >= last) { return; }
+
+    Cell* cell = mCells.data() + (y * mWidth) + x + first;
+    const CharT* c = str + first;
+    const CharT* end = str + last;
+
+    for (; c < end; c++, cell++)
     {
-        if (c == '\n')
+        if constexpr (Color == TextColor::Tagged)
         {
-            i = 0;
-            j++;
-            continue;
+            cell->character = c->character;
+            cell->foreground = (*style.tags)[c->tags & TaggedChar::FOREGROUND_MASK];
+            cell->background = (*style.tags)[(c->tags & TaggedChar::BACKGROUND_MASK) >> 4];
         }
-
-        if (i >= maxWidth)
+        else
         {
-            i = 0;
-            j++;
+            cell->character = (unsigned char)*c;
+
+            if constexpr (Color == TextColor::Foreground || Color == TextColor::ForegroundBackground)
+            {
+                cell->foreground = *style.foreground;
+            }
+            if constexpr (Color == TextColor::ForegroundBackground)
+            {
+                cell->background = *style.background;
+            }
         }
+    }
+
+    return;
+}
+
+//Each line is split into rows of maxWidth characters, a line that is exactly maxWidth long takes a single row
+//Rows above the screen are skipped without touching their characters, layout stops at the first row below maxHeight or the screen
+template<conslr::Screen::TextColor Color, typename CharT>
+void conslr::Screen::layoutText(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, std::span<const CharT> str, const TextStyle& style) noexcept
+{
+    if (maxWidth <= 0) { return; }
+
+    int32_t rowLimit = std::min(maxHeight, mHeight - y);
 
-        if (j >= maxHeight)
+    const CharT* line = str.data();
+    const CharT* end = str.data() + str.size();
+    int32_t j = 0;
+    while (line < end && j < rowLimit)
+    {
+        const CharT* newline;
+        if constexpr (std::is_same_v<CharT, char>)
         {
-            break;
+            newline = (const char*)std::memchr(line, '\n', end - line);
+            newline = newline == nullptr ? end : newline;
+        }
+        else
+        {
+            //Tag bytes can also equal '\n', so matches that are not on a character byte are skipped
+            static_assert(sizeof(TaggedChar) == 2 && offsetof(TaggedChar, character) == 0);
+            const char* begin = (const char*)line;
+            const char* found = begin;
+            while ((found = (const char*)std::memchr(found, '\n', (const char*)end - found)) != nullptr && (found - begin) % 2 != 0)
+            {
+                found++;
+            }
+            newline = found == nullptr ? end : line + ((found - begin) / 2);
         }
 
-        if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+        int32_t length = (int32_t)(newline - line);
+        int32_t rows = std::max(1, (length + maxWidth - 1) / maxWidth);
 
-        auto& cell = mCells.at(((j + y) * mWidth) + x + i);
+        for (auto r = 0; r < rows && j < rowLimit; r++, j++)
+        {
+            if (y + j < 0) { continue; }
 
-        cell.character = (unsigned char)c;
-        cell.foreground = color;
+            int32_t offset = r * maxWidth;
+            writeRow<Color>(x, y + j, line + offset, std::min(maxWidth, length - offset), style);
+        }
 
-        i++;
+        line = newline + 1;
     }
 
-    mRerender = true;
-
     return;
 }
 
-void conslr::Screen::renderMultilineTextColor(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const std::string& str, const SDL_Color& foreground, const SDL_Color& background)
+//Walks the widgets from the top down, keeping track of which cells are covered by opaque widgets
+//A widget is culled if its region is entirely off screen, or every cell of its region is already covered
+//Widgets without a region are always drawn and never cover anything
+void conslr::Screen::cull()
 {
-    int32_t i = 0;
-    int32_t j = 0;
-    for (const auto& c : str)
+    mDrawList.clear();
+    mFrameStats = {};
+    std::fill(mCoverage.begin(), mCoverage.end(), 0);
+
+    const auto& renderable = mWidgetManager.getRenderable();
+    for (auto it = renderable.rbegin(); it != renderable.rend(); it++)
     {
-        if (c == '\n')
+        IRenderable* ptr = it->renderable;
+        if (!ptr->isVisible())
         {
-            i = 0;
-            j++;
             continue;
         }
 
-        if (i >= maxWidth)
+        const SDL_Rect& region = ptr->getRegion();
+        if (region.w <= 0 || region.h <= 0)
         {
-            i = 0;
-            j++;
+            mDrawList.push_back(ptr);
+            mFrameStats.rendered++;
+            continue;
         }
 
-        if (j >= maxHeight)
+        //Region clipped to the screen
+        int32_t x0 = std::max(region.x, 0);
+        int32_t y0 = std::max(region.y, 0);
+        int32_t x1 = std::min(region.x + region.w, mWidth);
+        int32_t y1 = std::min(region.y + region.h, mHeight);
+
+        if (x0 >= x1 || y0 >= y1)
         {
-            break;
+            mFrameStats.culledOffscreen++;
+            continue;
         }
 
-        if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
+        bool covered = true;
+        for (auto j = y0; j < y1 && covered; j++)
+        {
+            const uint8_t* row = mCoverage.data() + (j * mWidth);
+            covered = std::all_of(row + x0, row + x1, [](uint8_t c) { return c != 0; });
+        }
+
+        if (covered)
+        {
+            mFrameStats.culledOccluded++;
+            continue;
+        }
 
-        auto& cell = mCells.at(((j + y) * mWidth) + x + i);
+        if (ptr->isOpaque())
+        {
+            for (auto j = y0; j < y1; j++)
+            {
+                std::fill_n(mCoverage.begin() + (j * mWidth) + x0, x1 - x0, 1);
+            }
+        }
 
-        cell.character = (unsigned char)c;
-        cell.foreground = foreground;
-        cell.background = background;
-        i++;
+        mDrawList.push_back(ptr);
+        mFrameStats.rendered++;
     }
 
-    mRerender = true;
-
     return;
 }
 
-void conslr::Screen::renderTextTagged(int32_t x, int32_t y, int32_t maxSize, const TaggedString& str, const TagSet& tags)
+//Layout positions stay the same as long as the same widgets are visible in the same order
+//In that case only the regions that moved are updated in the grid, and only the cells they covered or now cover get new owners
+//Otherwise the grid and owners are rebuilt
+void conslr::Screen::updateLayout()
 {
-    if (y < 0 || y >= mHeight) { return; }
-
-    int32_t itrSize = std::min(maxSize, (int32_t)str.str.size());
-    int32_t start = (y * mWidth) + x;
-    for (int i = 0; i < itrSize; i++)
+    mNextLayout.clear();
+    for (auto& entry : mWidgetManager.getRenderable())
     {
-        if (x + i < 0 || x + i >= mWidth) { continue; }
+        if (!entry.renderable->isVisible())
+        {
+            continue;
+        }
+
+        const SDL_Rect& region = entry.renderable->getRegion();
+        if (region.w <= 0 || region.h <= 0)
+        {
+            continue;
+        }
+
+        mNextLayout.push_back({ entry.id, region });
+    }
 
-        auto& cell = mCells.at(start + i);
-        //Current tagged character
-        const auto& tc = str.str.at(i);
-        //Current indexs of the color tags
-        uint8_t bg = (tc.tags & TaggedChar::BACKGROUND_MASK) >> 4;
-        uint8_t fg = tc.tags & TaggedChar::FOREGROUND_MASK;
+    bool sameWidgets = mNextLayout.size() == mLayout.size() &&
+        std::equal(mNextLayout.begin(), mNextLayout.end(), mLayout.begin(), [](const LayoutEntry& a, const LayoutEntry& b) { return a.id == b.id; });
 
-        cell.character = tc.character;
+    if (!sameWidgets)
+    {
+        std::swap(mLayout, mNextLayout);
 
+        for (auto& bucket : mGrid)
+        {
+            bucket.clear();
+        }
+        for (size_t i = 0; i < mLayout.size(); i++)
+        {
+            gridInsert(i, mLayout.at(i).region);
+        }
 
-        cell.foreground = tags.at(fg);
-        cell.background = tags.at(bg);
+        updateOwners({ 0, 0, mWidth, mHeight });
+
+        return;
     }
 
-    mRerender = true;
+    for (size_t i = 0; i < mLayout.size(); i++)
+    {
+        SDL_Rect oldRegion = mLayout.at(i).region;
+        const SDL_Rect& newRegion = mNextLayout.at(i).region;
+        if (oldRegion.x == newRegion.x && oldRegion.y == newRegion.y && oldRegion.w == newRegion.w && oldRegion.h == newRegion.h)
+        {
+            continue;
+        }
+
+        gridErase(i, oldRegion);
+        mLayout.at(i).region = newRegion;
+        gridInsert(i, newRegion);
+
+        updateOwners(oldRegion);
+        updateOwners(newRegion);
+    }
 
     return;
 }
 
-void conslr::Screen::renderMultilineTextTagged(int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, const TaggedString& str, const TagSet& tags)
+void conslr::Screen::updateOwners(SDL_Rect rect)
 {
-    int32_t i = 0;
-    int32_t j = 0;
-    for (const auto& tc : str.str)
+    int32_t x0 = std::max(rect.x, 0);
+    int32_t y0 = std::max(rect.y, 0);
+    int32_t x1 = std::min(rect.x + rect.w, mWidth);
+    int32_t y1 = std::min(rect.y + rect.h, mHeight);
+
+    for (auto j = y0; j < y1; j++)
     {
-        if (tc.character == '\n')
+        for (auto i = x0; i < x1; i++)
         {
-            i = 0;
-            j++;
-            continue;
+            const auto& bucket = mGrid[((j / GRID_SIZE) * mGridWidth) + (i / GRID_SIZE)];
+            int32_t owner = -1;
+
+            //Buckets are in render order, so the first match from the back is the topmost widget
+            for (auto it = bucket.rbegin(); it != bucket.rend(); it++)
+            {
+                const SDL_Rect& region = mLayout[*it].region;
+                if (i >= region.x && i < region.x + region.w && j >= region.y && j < region.y + region.h)
+                {
+                    owner = mLayout[*it].id;
+                    break;
+                }
+            }
+
+            mOwners[(j * mWidth) + i] = owner;
         }
+    }
 
-        if (i >= maxWidth)
-        {
-            i = 0;
-            j++;
-        }
+    return;
+}
 
-        if (j >= maxHeight)
+void conslr::Screen::gridInsert(int32_t position, const SDL_Rect& region)
+{
+    if (region.x >= mWidth || region.y >= mHeight || region.x + region.w <= 0 || region.y + region.h <= 0) { return; }
+
+    int32_t x0 = std::max(region.x, 0) / GRID_SIZE;
+    int32_t y0 = std::max(region.y, 0) / GRID_SIZE;
+    int32_t x1 = (std::min(region.x + region.w, mWidth) - 1) / GRID_SIZE;
+    int32_t y1 = (std::min(region.y + region.h, mHeight) - 1) / GRID_SIZE;
+
+    for (auto j = y0; j <= y1; j++)
+    {
+        for (auto i = x0; i <= x1; i++)
         {
-            break;
+            auto& bucket = mGrid[(j * mGridWidth) + i];
+            bucket.insert(std::lower_bound(bucket.begin(), bucket.end(), position), position);
         }
+    }
 
-        if (x + i < 0 || x + i >= mWidth || y + j < 0 || y + j >= mHeight) { i++; continue; }
-
-        auto& cell = mCells.at(((j + y) * mWidth) + x + i);
-        uint8_t bg = (tc.tags & TaggedChar::BACKGROUND_MASK) >> 4;
-        uint8_t fg = tc.tags & TaggedChar::FOREGROUND_MASK;
+    return;
+}
 
-        cell.character = tc.character;
+void conslr::Screen::gridErase(int32_t position, const SDL_Rect& region)
+{
+    if (region.x >= mWidth || region.y >= mHeight || region.x + region.w <= 0 || region.y + region.h <= 0) { return; }
 
-        cell.foreground = tags.at(fg);
-        cell.background = tags.at(bg);
+    int32_t x0 = std::max(region.x, 0) / GRID_SIZE;
+    int32_t y0 = std::max(region.y, 0) / GRID_SIZE;
+    int32_t x1 = (std::min(region.x + region.w, mWidth) - 1) / GRID_SIZE;
+    int32_t y1 = (std::min(region.y + region.h, mHeight) - 1) / GRID_SIZE;
 
-        i++;
+    for (auto j = y0; j <= y1; j++)
+    {
+        for (auto i = x0; i <= x1; i++)
+        {
+            auto& bucket = mGrid[(j * mGridWidth) + i];
+            auto it = std::lower_bound(bucket.begin(), bucket.end(), position);
+            if (it != bucket.end() && *it == position)
+            {
+                bucket.erase(it);
+            }
+        }
     }
 
-    mRerender = true;
-
     return;
 }
 
@@ -9,6 +9,7 @@
 #include "conslr/widgets/radiolist.hpp"
 #include "conslr/widgets/checklist.hpp"
 #include "conslr/widgets/progressbar.hpp"
+#include "conslr/widgets/logview.hpp"
 
 std::unordered_map<std::string, conslr::WidgetFactorySignature> conslr::WidgetFactory::mFactories;
 bool conslr::WidgetFactory::mInitialized = false;
@@ -24,6 +25,7 @@ void conslr::WidgetFactory::initialize()
     registerWidget("TaggedTextBox", widgets::constructTaggedTextBox);
     registerWidget("TextInput", widgets::constructTextInput);
     registerWidget("ProgressBar", widgets::constructProgressBar);
+    registerWidget("LogView", widgets::constructLogView);
 
     //Some template ones
     registerWidget("ScrollListInt", widgets::constructScrollList<int32_t>);
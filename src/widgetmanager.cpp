@@ -1,10 +1,12 @@
 #include "conslr/widgetmanager.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 #include <fstream>
 
 #include <nlohmann/json.hpp>
@@ -13,84 +15,197 @@
 
 conslr::WidgetManager::WidgetManager()
 {
-    for (int i = 0; i < MAX_WIDGETS; i++)
-    {
-        mFreeWidgets.push(i);
-        mWidgets.at(i) = nullptr;
-    }
-
     return;
 }
 
-void conslr::WidgetManager::destroyWidget(int32_t index)
+void conslr::WidgetManager::destroyWidget(int32_t id)
 {
-    if (!(index >= 0 && index < MAX_WIDGETS))
+    static_cast<void>(getSlot(id)); //Throws if the id is stale
+
+    int32_t index = id & INDEX_MASK;
+    Slot& slot = mSlots[index];
+
+    //Move the last dense widget into the hole
+    IWidget* last = mDense.back();
+    mDense[slot.dense] = last;
+    mSlots[last->getId() & INDEX_MASK].dense = slot.dense;
+    mDense.pop_back();
+
+    if (mFocused == id)
     {
-        throw std::invalid_argument("Widget index is out of bounds, index: " + std::to_string(index));
+        mFocused = -1;
     }
-    if (mWidgets.at(index) == nullptr)
+    if (mPreviousFocused == id)
     {
-        throw std::runtime_error("Widget at index is already nullptr, index: " + std::to_string(index));
+        mPreviousFocused = -1;
     }
 
-    mWidgets.at(index) = nullptr;
+    auto it = findRenderable(id, slot.widget->getPriority());
+    if (it != mRenderable.end())
+    {
+        mRenderable.erase(it);
+    }
 
-    for (auto it = mRenderable.begin(); it != mRenderable.end(); it++)
+    IRenderable* renderable = slot.interfaces.renderable;
+    if (renderable != nullptr && renderable->mRerender)
     {
-        if (std::dynamic_pointer_cast<IWidget>(*it)->getId() == index)
+        auto dirtyIt = std::find(mDirty.begin(), mDirty.end(), renderable);
+        if (dirtyIt != mDirty.end())
         {
-            mRenderable.erase(it);
-            break;
+            mDirty.erase(dirtyIt);
         }
     }
 
-    mFreeWidgets.push(index);
+    if (slot.interfaces.updatable != nullptr)
+    {
+        mUpdatable.erase(std::find(mUpdatable.begin(), mUpdatable.end(), slot.interfaces.updatable));
+    }
+
+    slot.widget = nullptr;
+    slot.interfaces = {};
+    slot.dense = -1;
+    slot.generation++;
+
+    //Retire slots that ran out of generations so their ids are never reused
+    if (slot.generation <= MAX_GENERATION)
+    {
+        slot.nextFree = mFreeHead;
+        mFreeHead = index;
+    }
 
     return;
 }
 
-void conslr::WidgetManager::activateWidget(int32_t index)
+void conslr::WidgetManager::activateWidget(int32_t id)
 {
-    if (!(index >= 0 && index < MAX_WIDGETS))
+    const Slot& slot = getSlot(id);
+
+    //Only the widget's own appearance depends on its active state
+    if (!slot.widget->getActive())
     {
-        throw std::invalid_argument("Widget index is out of bounds, index: " + std::to_string(index));
+        slot.widget->setActive(true);
+        if (slot.interfaces.renderable != nullptr)
+        {
+            slot.interfaces.renderable->invalidate();
+        }
+    }
+
+    if (mFocused != id)
+    {
+        mPreviousFocused = mFocused;
+        mFocused = id;
     }
-    if (mWidgets.at(index) == nullptr)
+
+    return;
+}
+
+void conslr::WidgetManager::deactivateWidget(int32_t id)
+{
+    const Slot& slot = getSlot(id);
+
+    if (slot.widget->getActive())
+    {
+        slot.widget->setActive(false);
+        if (slot.interfaces.renderable != nullptr)
+        {
+            slot.interfaces.renderable->invalidate();
+        }
+    }
+
+    if (mFocused == id)
     {
-        throw std::invalid_argument("Widget at index is nullptr, index: " + std::to_string(index));
+        mPreviousFocused = mFocused;
+        mFocused = -1;
     }
 
-    for (auto renderablePtr : mRenderable)
+    return;
+}
+
+void conslr::WidgetManager::setPriority(int32_t id, int32_t priority)
+{
+    const Slot& slot = getSlot(id);
+
+    auto it = findRenderable(id, slot.widget->getPriority());
+    slot.widget->mPriority = priority;
+
+    if (it == mRenderable.end())
     {
-        renderablePtr->mRerender = true;
+        return;
     }
 
-    mWidgets.at(index)->setActive(true);
+    RenderEntry entry = *it;
+    mRenderable.erase(it);
+    entry.priority = priority;
+    insertRenderable(entry);
+
+    entry.renderable->invalidate();
 
     return;
 }
 
-void conslr::WidgetManager::deactivateWidget(int32_t index)
+void conslr::WidgetManager::focusNext()
 {
-    if (!(index >= 0 && index < MAX_WIDGETS))
+    //Focusable widgets in render order
+    std::vector<int32_t> focusable;
+    for (auto& entry : mRenderable)
     {
-        throw std::invalid_argument("Widget index is out of bounds, index: " + std::to_string(index));
+        if (!entry.renderable->isVisible())
+        {
+            continue;
+        }
+
+        const auto& interfaces = getInterfaces(entry.id);
+        if (interfaces.scrollable || interfaces.textInput)
+        {
+            focusable.push_back(entry.id);
+        }
     }
-    if (mWidgets.at(index) == nullptr)
+
+    if (focusable.empty())
     {
-        throw std::runtime_error("Widget at index is nullptr, index: " + std::to_string(index));
+        return;
     }
 
-    for (auto renderablePtr : mRenderable)
+    auto it = std::find(focusable.begin(), focusable.end(), mFocused);
+    int32_t next = (it == focusable.end() || it + 1 == focusable.end()) ? focusable.front() : *(it + 1);
+
+    if (mFocused >= 0)
     {
-        renderablePtr->mRerender = true;
+        deactivateWidget(mFocused);
     }
+    activateWidget(next);
 
-    mWidgets.at(index)->setActive(false);
+    return;
+}
+
+void conslr::WidgetManager::updateWidgets()
+{
+    for (auto* updatable : mUpdatable)
+    {
+        updatable->update();
+    }
 
     return;
 }
 
+void conslr::WidgetManager::insertRenderable(const RenderEntry& entry)
+{
+    auto it = std::upper_bound(mRenderable.begin(), mRenderable.end(), entry.priority,
+            [](int32_t priority, const RenderEntry& e) { return priority < e.priority; });
+    mRenderable.insert(it, entry);
+
+    return;
+}
+
+std::vector<conslr::WidgetManager::RenderEntry>::iterator conslr::WidgetManager::findRenderable(int32_t id, int32_t priority) noexcept
+{
+    auto [first, last] = std::equal_range(mRenderable.begin(), mRenderable.end(), RenderEntry{ nullptr, priority, id },
+            [](const RenderEntry& a, const RenderEntry& b) { return a.priority < b.priority; });
+
+    auto it = std::find_if(first, last, [id](const RenderEntry& e) { return e.id == id; });
+    return it == last ? mRenderable.end() : it;
+}
+
 //Loads the file into json, assuming its formed correctly
 //Data from the json file gets passed in the form of [parameter, value], where parameter is used to modify the widget in some way
 //The WidgetFactory takes the [param, value] pairs and creates the widget through WidgetManager
@@ -154,17 +269,13 @@ std::unordered_map<std::string, int32_t> conslr::WidgetManager::loadWidgetsFromF
 
 void conslr::WidgetManager::clear()
 {
-    std::queue<int32_t> empty;
-    std::swap(mFreeWidgets, empty);
-    for (auto i = 0; i < MAX_WIDGETS; i++)
+    //Destroy widgets one by one so their slots get new generations and old ids stay stale
+    while (!mDense.empty())
     {
-        mFreeWidgets.push(i);
+        destroyWidget(mDense.back()->getId());
     }
-    
-    std::array<std::shared_ptr<IWidget>, MAX_WIDGETS> emptyArr{};
-    std::swap(mWidgets, emptyArr);
-
-    mRenderable.clear();
+    mFocused = -1;
+    mPreviousFocused = -1;
 
     return;
 }